@@ -71,7 +71,7 @@ void Axiom::dump() const {
   cout << endl;
 }
 
-void Axiom::generate_cpp_input(ofstream &outfile) const {
+void Axiom::generate_cpp_input(ostream &outfile) const {
   assert(effect_var->get_level() != -1);
   outfile << "begin_rule" << endl;
   outfile << conditions.size() << endl;
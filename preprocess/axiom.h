@@ -48,7 +48,7 @@ public:
 
   bool is_redundant() const;
   void dump() const;
-  void generate_cpp_input(ofstream &outfile) const;
+  void generate_cpp_input(ostream &outfile) const;
   const vector<Condition> &get_conditions() const {return conditions;}
   Variable* get_effect_var() const {return effect_var;}
   int get_old_val() const {return old_val;}
@@ -0,0 +1,94 @@
+/*********************************************************************
+ * This file is part of LAMA.
+ *
+ * LAMA is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the license, or (at your option) any later version.
+ *
+ * LAMA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ *********************************************************************/
+
+#include "axiom_layers.h"
+#include "axiom.h"
+#include "state.h"
+#include "variable.h"
+
+#include <iostream>
+using namespace std;
+
+bool g_axiom_layers = false;
+
+bool AxiomLayers::check(const vector<Axiom> &axioms,
+			const State &initial_state) {
+  rules_by_layer.clear();
+  rules_by_condition.clear();
+  bool ok = true;
+  for(int i = 0; i < axioms.size(); i++) {
+    Variable *var = axioms[i].get_effect_var();
+    int layer = var->get_layer();
+    if(!var->is_derived()) {
+      cout << "Axiom rule " << i << " derives " << var->get_name()
+	   << ", which is not a derived variable." << endl;
+      ok = false;
+      continue;
+    }
+    const vector<Axiom::Condition> &conditions = axioms[i].get_conditions();
+    for(int j = 0; j < conditions.size(); j++) {
+      Variable *cond_var = conditions[j].var;
+      int cond_layer = cond_var->get_layer();
+      if(cond_layer > layer) {
+	cout << "Axiom rule " << i << " for " << var->get_name()
+	     << " (layer " << layer << ") depends on " << cond_var->get_name()
+	     << " of the higher layer " << cond_layer << "." << endl;
+	ok = false;
+      } else if(cond_layer == layer &&
+		conditions[j].cond == initial_state[cond_var]) {
+	cout << "Axiom rule " << i << " for " << var->get_name()
+	     << " (layer " << layer << ") depends on the default value of "
+	     << cond_var->get_name() << " of the same layer." << endl;
+	ok = false;
+      }
+      vector<int> &rules =
+	rules_by_condition[make_pair(cond_var->get_level(), conditions[j].cond)];
+      if(rules.empty() || rules.back() != i)
+	rules.push_back(i);
+    }
+    rules_by_layer[layer][var->get_level()].push_back(i);
+  }
+  checked = ok;
+  return ok;
+}
+
+void AxiomLayers::generate_cpp_input(ostream &outfile) const {
+  outfile << "begin_axiom_layers" << endl;
+  outfile << rules_by_layer.size() << endl;
+  for(map<int, map<int, vector<int> > >::const_iterator layer =
+	rules_by_layer.begin(); layer != rules_by_layer.end(); ++layer) {
+    outfile << layer->first << " " << layer->second.size() << endl;
+    for(map<int, vector<int> >::const_iterator var = layer->second.begin();
+	var != layer->second.end(); ++var) {
+      outfile << var->first << " " << var->second.size();
+      for(int i = 0; i < var->second.size(); i++)
+	outfile << " " << var->second[i];
+      outfile << endl;
+    }
+  }
+  outfile << rules_by_condition.size() << endl;
+  for(map<pair<int, int>, vector<int> >::const_iterator fact =
+	rules_by_condition.begin(); fact != rules_by_condition.end(); ++fact) {
+    outfile << fact->first.first << " " << fact->first.second << " "
+	    << fact->second.size();
+    for(int i = 0; i < fact->second.size(); i++)
+      outfile << " " << fact->second[i];
+    outfile << endl;
+  }
+  outfile << "end_axiom_layers" << endl;
+}
@@ -0,0 +1,73 @@
+/*********************************************************************
+ * This file is part of LAMA.
+ *
+ * LAMA is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the license, or (at your option) any later version.
+ *
+ * LAMA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ *********************************************************************/
+
+#ifndef AXIOM_LAYERS_H
+#define AXIOM_LAYERS_H
+
+/*
+  Stratification of the axiom rules for incremental evaluation.
+
+  A derived variable of layer k is computed from its default value (its
+  value in the initial state) by the rules deriving it, after all layers
+  below k are final. So a rule for a variable of layer k may only depend
+  on derived variables of layers up to k, and on variables of layer k only
+  through their derived values, never through the default value. check()
+  verifies this for all rules. The rules are then grouped by layer and
+  derived variable, and indexed by the facts in their conditions, so that
+  an evaluator can count satisfied conditions per rule and only revisit
+  the rules whose conditions changed. The tables are written after the
+  main output:
+
+    begin_axiom_layers
+    <number of layers>
+    <layer> <number of derived variables>   (ascending layers)
+    <level> <k> <rule> ...                  (the k rules deriving a variable)
+    ...
+    <number of condition facts>
+    <level> <value> <k> <rule> ...          (the k rules with this condition,
+    ...                                       in (level, value) order)
+    end_axiom_layers
+
+  Rules are numbered by their position in the rule list of the output.
+*/
+
+#include <fstream>
+#include <map>
+#include <vector>
+using namespace std;
+
+class Axiom;
+class State;
+
+extern bool g_axiom_layers;
+
+class AxiomLayers {
+  // layer -> level of the derived variable -> rules
+  map<int, map<int, vector<int> > > rules_by_layer;
+  // (level, value) -> rules
+  map<pair<int, int>, vector<int> > rules_by_condition;
+  bool checked;
+public:
+  AxiomLayers() : checked(false) {}
+  // Reports every violation; returns false if there is one.
+  bool check(const vector<Axiom> &axioms, const State &initial_state);
+  bool is_checked() const {return checked;}
+  void generate_cpp_input(ostream &outfile) const;
+};
+
+#endif
@@ -66,17 +66,17 @@ void CausalGraph::weigh_graph_from_ops(const vector<Variable *> &,
 
 	// Get vectors of prevail and prepost
 	// prevail: Variable var*, int pre
-	// pre_post: Variable *var; int pre, post; float f_cost; bool is_conditional_effect; vector<EffCond> effect_conds;
-	// vector<EffCond> effect_conds: Variable *var; int cond;
-	const vector<Operator::Prevail> &prevail = operators[i].get_prevail();
-    const vector<Operator::PrePost> &pre_post = operators[i].get_pre_post();
+	// pre_post: Variable *var; int pre, post; bool is_conditional_effect; EffCondRange effect_conds;
+	// EffCondRange effect_conds: Variable *var; int cond;
+	Operator::PrevailRange prevail = operators[i].get_prevail();
+    Operator::PrePostRange pre_post = operators[i].get_pre_post();
 
     // Sources are the origin states from prevail and prepost effects
     vector<Variable *> source_vars;
     for(int j = 0; j < prevail.size(); j++)
       source_vars.push_back(prevail[j].var);
     for(int j = 0; j < pre_post.size(); j++)
-      if(pre_post[j].pre != -1)
+      if(pre_post[j].pre != PRE_ANY)
 	source_vars.push_back(pre_post[j].var);
 
     // For effect in pre_post -> the origin is target
@@ -349,7 +349,7 @@ void CausalGraph::dump() const {
       cout << "  [" << it->first->get_name() << ", " << it->second << "]" << endl; 
   }
 }
-void CausalGraph::generate_cpp_input(ofstream &outfile,
+void CausalGraph::generate_cpp_input(ostream &outfile,
 				     const vector<Variable *> & ordered_vars) 
   const {
   vector<WeightedSuccessors *> succs; // will be ordered like ordered_vars
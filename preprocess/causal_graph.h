@@ -70,7 +70,7 @@ public:
   const vector<Variable *> &get_variable_ordering() const;
   bool is_acyclic() const;
   void dump() const;
-  void generate_cpp_input(ofstream &outfile, 
+  void generate_cpp_input(ostream &outfile, 
 			  const vector<Variable *> & ordered_vars) const;
 };
 
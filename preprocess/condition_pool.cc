@@ -0,0 +1,80 @@
+/*********************************************************************
+ * This file is part of LAMA.
+ *
+ * LAMA is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the license, or (at your option) any later version.
+ *
+ * LAMA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ *********************************************************************/
+
+#include "condition_pool.h"
+
+#include <algorithm>
+using namespace std;
+
+ConditionPool::ConditionPool(const FactIndex &fact_index)
+  : facts(fact_index) {
+  set_starts.push_back(0);
+}
+
+unsigned int ConditionPool::hash_facts(const vector<int> &facts) {
+  // FNV-1a over the fact IDs
+  unsigned int hash = 2166136261U;
+  for(int i = 0; i < facts.size(); i++) {
+    hash ^= static_cast<unsigned int>(facts[i]);
+    hash *= 16777619U;
+  }
+  return hash;
+}
+
+bool ConditionPool::set_equals(ConditionID id, const vector<int> &facts) const {
+  return size(id) == facts.size() && equal(facts.begin(), facts.end(), begin(id));
+}
+
+void ConditionPool::insert_into_table(ConditionID id) {
+  unsigned int mask = table.size() - 1;
+  unsigned int pos = set_hashes[id] & mask;
+  while(table[pos] != -1)
+    pos = (pos + 1) & mask;
+  table[pos] = id;
+}
+
+void ConditionPool::grow_table() {
+  table.assign(table.empty() ? 1024 : table.size() * 2, -1);
+  for(ConditionID id = 0; id < set_hashes.size(); id++)
+    insert_into_table(id);
+}
+
+ConditionID ConditionPool::intern(vector<int> &facts) {
+  sort(facts.begin(), facts.end());
+  facts.erase(unique(facts.begin(), facts.end()), facts.end());
+  unsigned int hash = hash_facts(facts);
+
+  // Keep the table at most half full.
+  if(2 * (set_hashes.size() + 1) > table.size())
+    grow_table();
+  unsigned int mask = table.size() - 1;
+  for(unsigned int pos = hash & mask;; pos = (pos + 1) & mask) {
+    ConditionID id = table[pos];
+    if(id == -1)
+      break;
+    if(set_hashes[id] == hash && set_equals(id, facts))
+      return id;
+  }
+
+  ConditionID id = set_hashes.size();
+  set_facts.insert(set_facts.end(), facts.begin(), facts.end());
+  set_starts.push_back(set_facts.size());
+  set_hashes.push_back(hash);
+  insert_into_table(id);
+  return id;
+}
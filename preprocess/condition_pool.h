@@ -0,0 +1,69 @@
+/*********************************************************************
+ * This file is part of LAMA.
+ *
+ * LAMA is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the license, or (at your option) any later version.
+ *
+ * LAMA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ *********************************************************************/
+
+#ifndef CONDITION_POOL_H
+#define CONDITION_POOL_H
+
+/*
+  Interned condition sets. Every distinct set of facts (as sorted fact IDs
+  of a FactIndex) is stored once and referred to by its ConditionID, so
+  equal conditions can be compared by ID. IDs are handed out in the order
+  in which sets are first interned.
+
+  Interning is not thread-safe; reading is, as long as nothing is
+  interned at the same time.
+*/
+
+#include <vector>
+using namespace std;
+
+class FactIndex;
+
+typedef int ConditionID;
+
+class ConditionPool {
+  const FactIndex &facts;
+  vector<int> set_facts;      // all sets, one after the other
+  vector<int> set_starts;     // set i is [set_starts[i], set_starts[i + 1])
+  vector<unsigned int> set_hashes;
+  vector<ConditionID> table;  // open addressing, -1 marks a free slot
+
+  static unsigned int hash_facts(const vector<int> &facts);
+  bool set_equals(ConditionID id, const vector<int> &facts) const;
+  void insert_into_table(ConditionID id);
+  void grow_table();
+public:
+  typedef vector<int>::const_iterator const_iterator;
+
+  ConditionPool(const FactIndex &facts);
+  // Sorts the facts, removes duplicates and returns the ID of the set.
+  ConditionID intern(vector<int> &facts);
+  const_iterator begin(ConditionID id) const {
+    return set_facts.begin() + set_starts[id];
+  }
+  const_iterator end(ConditionID id) const {
+    return set_facts.begin() + set_starts[id + 1];
+  }
+  int size(ConditionID id) const {
+    return set_starts[id + 1] - set_starts[id];
+  }
+  int get_num_conditions() const {return set_hashes.size();}
+  const FactIndex &get_fact_index() const {return facts;}
+};
+
+#endif
@@ -0,0 +1,249 @@
+/*********************************************************************
+ * This file is part of LAMA.
+ *
+ * LAMA is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the license, or (at your option) any later version.
+ *
+ * LAMA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ *********************************************************************/
+
+#include "cost_bytecode.h"
+#include "operator.h"
+#include "variable.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+using namespace std;
+
+bool g_cost_bytecode = false;
+
+// A lexical item of an expression: a number, a variable level or one of
+// the characters + - * / ( ).
+struct CostItem {
+  enum Kind {NUMBER, VARIABLE, SYMBOL};
+  Kind kind;
+  double value;
+  char symbol;
+  CostItem(Kind k, double v, char s) : kind(k), value(v), symbol(s) {}
+};
+
+class CostExpressionCompiler {
+  vector<CostItem> items;
+  int pos;
+  vector<CostInstruction> &code;
+
+  bool lex(const OperatorArena &arena, int expression,
+	   const vector<Variable *> &variables);
+  bool is_symbol(char c) const {
+    return pos < items.size() && items[pos].kind == CostItem::SYMBOL &&
+      items[pos].symbol == c;
+  }
+  void emit_binary(char op, int left_start, int right_start);
+  bool parse_sum();
+  bool parse_product();
+  bool parse_factor();
+public:
+  CostExpressionCompiler(vector<CostInstruction> &c) : pos(0), code(c) {}
+  bool compile(const OperatorArena &arena, int expression,
+	       const vector<Variable *> &variables);
+};
+
+bool CostExpressionCompiler::lex(const OperatorArena &arena, int expression,
+			     const vector<Variable *> &variables) {
+  for(int i = arena.expression_begin[expression];
+      i < arena.expression_begin[expression + 1]; i++) {
+    int token = arena.expression_tokens[i];
+    if(token >= 0) {
+      items.push_back(CostItem(CostItem::VARIABLE, variables[token]->get_level(), 0));
+      continue;
+    }
+    const string &text = arena.expression_literals[-token - 1];
+    const char *c = text.c_str();
+    while(*c) {
+      if(*c == ' ' || *c == '\t') {
+	c++;
+      } else if((*c >= '0' && *c <= '9') || *c == '.') {
+	char *end;
+	double value = strtod(c, &end);
+	if(end == c)
+	  return false;
+	items.push_back(CostItem(CostItem::NUMBER, value, 0));
+	c = end;
+      } else if(*c == '+' || *c == '-' || *c == '*' || *c == '/' ||
+		*c == '(' || *c == ')') {
+	items.push_back(CostItem(CostItem::SYMBOL, 0, *c));
+	c++;
+      } else {
+	return false;
+      }
+    }
+  }
+  return true;
+}
+
+// Emits the operator for the operands compiled at [left_start, right_start)
+// and [right_start, end), folding it if both are constants.
+void CostExpressionCompiler::emit_binary(char op, int left_start, int right_start) {
+  if(right_start == left_start + 1 && code.size() == right_start + 1 &&
+     code[left_start].code == CostInstruction::CONSTANT &&
+     code[right_start].code == CostInstruction::CONSTANT &&
+     !(op == '/' && code[right_start].value == 0)) {
+    double left = code[left_start].value, right = code[right_start].value;
+    double result = op == '+' ? left + right : op == '-' ? left - right :
+                    op == '*' ? left * right : left / right;
+    code.pop_back();
+    code.back().value = result;
+    return;
+  }
+  switch(op) {
+  case '+': code.push_back(CostInstruction(CostInstruction::ADD)); break;
+  case '-': code.push_back(CostInstruction(CostInstruction::SUB)); break;
+  case '*': code.push_back(CostInstruction(CostInstruction::MUL)); break;
+  default: code.push_back(CostInstruction(CostInstruction::DIV)); break;
+  }
+}
+
+bool CostExpressionCompiler::parse_sum() {
+  int left_start = code.size();
+  if(!parse_product())
+    return false;
+  while(is_symbol('+') || is_symbol('-')) {
+    char op = items[pos++].symbol;
+    int right_start = code.size();
+    if(!parse_product())
+      return false;
+    emit_binary(op, left_start, right_start);
+  }
+  return true;
+}
+
+bool CostExpressionCompiler::parse_product() {
+  int left_start = code.size();
+  if(!parse_factor())
+    return false;
+  while(is_symbol('*') || is_symbol('/')) {
+    char op = items[pos++].symbol;
+    int right_start = code.size();
+    if(!parse_factor())
+      return false;
+    emit_binary(op, left_start, right_start);
+  }
+  return true;
+}
+
+bool CostExpressionCompiler::parse_factor() {
+  if(pos == items.size())
+    return false;
+  const CostItem &item = items[pos++];
+  if(item.kind == CostItem::NUMBER) {
+    code.push_back(CostInstruction(CostInstruction::CONSTANT, item.value));
+    return true;
+  } else if(item.kind == CostItem::VARIABLE) {
+    code.push_back(CostInstruction(CostInstruction::VARIABLE, item.value));
+    return true;
+  } else if(item.symbol == '+') {
+    return parse_factor();
+  } else if(item.symbol == '-') {
+    int start = code.size();
+    if(!parse_factor())
+      return false;
+    if(code.size() == start + 1 && code[start].code == CostInstruction::CONSTANT)
+      code[start].value = -code[start].value;
+    else
+      code.push_back(CostInstruction(CostInstruction::NEG));
+    return true;
+  } else if(item.symbol == '(') {
+    if(!parse_sum() || !is_symbol(')'))
+      return false;
+    pos++;
+    return true;
+  }
+  return false;
+}
+
+bool CostExpressionCompiler::compile(const OperatorArena &arena, int expression,
+				 const vector<Variable *> &variables) {
+  items.clear();
+  pos = 0;
+  code.clear();
+  return lex(arena, expression, variables) && parse_sum() && pos == items.size();
+}
+
+bool compile_cost_expression(const OperatorArena &arena, int expression,
+			     const vector<Variable *> &variables,
+			     vector<CostInstruction> &code) {
+  return CostExpressionCompiler(code).compile(arena, expression, variables);
+}
+
+static void write_bytecode(ostream &outfile, int op, int effect,
+			   const OperatorArena &arena, int expression,
+			   const vector<Variable *> &variables,
+			   vector<CostInstruction> &code, int &compiled) {
+  outfile << op << " " << effect;
+  if(!compile_cost_expression(arena, expression, variables, code)) {
+    outfile << " -1" << endl;
+    return;
+  }
+  compiled++;
+  outfile << " " << code.size();
+  for(int i = 0; i < code.size(); i++) {
+    switch(code[i].code) {
+    case CostInstruction::CONSTANT: outfile << " c " << code[i].value; break;
+    case CostInstruction::VARIABLE: outfile << " v " << int(code[i].value); break;
+    case CostInstruction::ADD: outfile << " +"; break;
+    case CostInstruction::SUB: outfile << " -"; break;
+    case CostInstruction::MUL: outfile << " *"; break;
+    case CostInstruction::DIV: outfile << " /"; break;
+    case CostInstruction::NEG: outfile << " n"; break;
+    }
+  }
+  outfile << endl;
+}
+
+void generate_cost_bytecode(ostream &outfile,
+			    const vector<Operator> &operators,
+			    const vector<Variable *> &variables) {
+  int count = 0;
+  for(int i = 0; i < operators.size(); i++) {
+    if(operators[i].get_runtime_cost_expression() != -1)
+      count++;
+    Operator::PrePostRange numeric = operators[i].get_numeric_effects();
+    for(int j = 0; j < numeric.size(); j++)
+      if(operators[i].get_numeric_effect(j).expression != -1)
+	count++;
+  }
+
+  // Folded constants are written so that they read back exactly.
+  streamsize old_precision = outfile.precision(17);
+  vector<CostInstruction> code;
+  int compiled = 0;
+  outfile << "begin_cost_bytecode" << endl;
+  outfile << count << endl;
+  for(int i = 0; i < operators.size(); i++) {
+    const Operator &op = operators[i];
+    const OperatorArena &arena = op.get_arena();
+    if(op.get_runtime_cost_expression() != -1)
+      write_bytecode(outfile, i, -1, arena, op.get_runtime_cost_expression(),
+		     variables, code, compiled);
+    Operator::PrePostRange numeric = op.get_numeric_effects();
+    for(int j = 0; j < numeric.size(); j++) {
+      const OperatorArena::NumericEffect &effect = op.get_numeric_effect(j);
+      if(effect.expression != -1)
+	write_bytecode(outfile, i, effect.position, arena, effect.expression,
+		       variables, code, compiled);
+    }
+  }
+  outfile << "end_cost_bytecode" << endl;
+  outfile.precision(old_precision);
+  cout << compiled << " of " << count << " cost expressions compiled." << endl;
+}
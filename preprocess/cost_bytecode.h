@@ -0,0 +1,73 @@
+/*********************************************************************
+ * This file is part of LAMA.
+ *
+ * LAMA is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the license, or (at your option) any later version.
+ *
+ * LAMA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ *********************************************************************/
+
+#ifndef COST_BYTECODE_H
+#define COST_BYTECODE_H
+
+/*
+  Compilation of the runtime cost expressions of operators and the cost
+  expressions of numeric effects into stack-machine code, so that the
+  search does not have to parse them.
+
+  Expressions are infix arithmetic over numbers and variable references
+  with + - * /, unary minus and parentheses. Variable references become
+  the level of the variable and constant subexpressions are folded. The
+  section written after the causal graph is
+
+    begin_cost_bytecode
+    <number of expressions>
+    <operator> <effect> <length> <instruction>...
+    ...
+    end_cost_bytecode
+
+  where <effect> is the position of the numeric effect in the operator,
+  or -1 for the runtime cost of the operator. An instruction is one of
+  "c <value>" (push constant), "v <level>" (push variable), "+", "-",
+  "*", "/" (pop two values, push the result) or "n" (negate). A length
+  of -1 (with no instructions) marks an expression that could not be
+  compiled; its text in the operator has to be used instead.
+*/
+
+#include <fstream>
+#include <vector>
+using namespace std;
+
+class Operator;
+class Variable;
+struct OperatorArena;
+
+extern bool g_cost_bytecode;
+
+struct CostInstruction {
+  enum Code {CONSTANT, VARIABLE, ADD, SUB, MUL, DIV, NEG};
+  Code code;
+  double value; // constant, or level of the variable
+  CostInstruction(Code c, double v = 0) : code(c), value(v) {}
+};
+
+// Compiles a cost expression of the arena; returns false if it cannot be
+// compiled.
+extern bool compile_cost_expression(const OperatorArena &arena, int expression,
+				    const vector<Variable *> &variables,
+				    vector<CostInstruction> &code);
+
+extern void generate_cost_bytecode(ostream &outfile,
+				   const vector<Operator> &operators,
+				   const vector<Variable *> &variables);
+
+#endif
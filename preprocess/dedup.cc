@@ -0,0 +1,354 @@
+/*********************************************************************
+ * This file is part of LAMA.
+ *
+ * LAMA is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the license, or (at your option) any later version.
+ *
+ * LAMA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ *********************************************************************/
+
+#include "dedup.h"
+#include "operator.h"
+#include "axiom.h"
+#include "variable.h"
+#include "fact_index.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+using namespace std;
+
+bool g_dedup = false;
+bool g_prune_dominated = false;
+
+/*
+  Canonical signatures, interned the same way as condition sets (see
+  ConditionPool), but as sequences: the order of the entries is part of
+  the signature, so callers sort what is unordered before interning.
+*/
+class SignatureTable {
+  vector<int> entries;
+  vector<int> starts;
+  vector<unsigned int> hashes;
+  vector<int> table; // open addressing, -1 marks a free slot
+
+  static unsigned int hash_signature(const vector<int> &signature) {
+    // FNV-1a over the entries
+    unsigned int hash = 2166136261U;
+    for(int i = 0; i < signature.size(); i++) {
+      hash ^= static_cast<unsigned int>(signature[i]);
+      hash *= 16777619U;
+    }
+    return hash;
+  }
+  bool signature_equals(int id, const vector<int> &signature) const {
+    return starts[id + 1] - starts[id] == signature.size() &&
+      equal(signature.begin(), signature.end(), entries.begin() + starts[id]);
+  }
+  void insert_into_table(int id) {
+    unsigned int mask = table.size() - 1;
+    unsigned int pos = hashes[id] & mask;
+    while(table[pos] != -1)
+      pos = (pos + 1) & mask;
+    table[pos] = id;
+  }
+  void grow_table() {
+    table.assign(table.empty() ? 1024 : table.size() * 2, -1);
+    for(int id = 0; id < hashes.size(); id++)
+      insert_into_table(id);
+  }
+public:
+  SignatureTable() {
+    starts.push_back(0);
+  }
+  // Returns the ID of the signature; new signatures get the next ID.
+  int intern(const vector<int> &signature) {
+    unsigned int hash = hash_signature(signature);
+    if(2 * (hashes.size() + 1) > table.size())
+      grow_table();
+    unsigned int mask = table.size() - 1;
+    for(unsigned int pos = hash & mask;; pos = (pos + 1) & mask) {
+      int id = table[pos];
+      if(id == -1)
+	break;
+      if(hashes[id] == hash && signature_equals(id, signature))
+	return id;
+    }
+    int id = hashes.size();
+    entries.insert(entries.end(), signature.begin(), signature.end());
+    starts.push_back(entries.size());
+    hashes.push_back(hash);
+    insert_into_table(id);
+    return id;
+  }
+};
+
+static void append_expression(vector<int> &signature, const OperatorArena &arena,
+			      int expression) {
+  if(expression == -1) {
+    signature.push_back(-1);
+    return;
+  }
+  int begin = arena.expression_begin[expression];
+  int end = arena.expression_begin[expression + 1];
+  signature.push_back(end - begin);
+  signature.insert(signature.end(), arena.expression_tokens.begin() + begin,
+		   arena.expression_tokens.begin() + end);
+}
+
+static void append_operator_signature(vector<int> &signature, const Operator &op) {
+  const OperatorArena &arena = op.get_arena();
+
+  vector<pair<int, int> > prevail;
+  for(int i = 0; i < op.get_prevail().size(); i++) {
+    Operator::Prevail prev = op.get_prevail()[i];
+    prevail.push_back(make_pair(prev.var->get_index(), prev.prev));
+  }
+  sort(prevail.begin(), prevail.end());
+  signature.push_back(prevail.size());
+  for(int i = 0; i < prevail.size(); i++) {
+    signature.push_back(prevail[i].first);
+    signature.push_back(prevail[i].second);
+  }
+
+  // All effects (propositional, numeric and blocking); pre tells them apart.
+  vector<vector<int> > effects;
+  Operator::PrePostRange ranges[3] = {op.get_propositional_effects(),
+				      op.get_numeric_effects(),
+				      op.get_pre_block()};
+  for(int r = 0; r < 3; r++) {
+    for(int i = 0; i < ranges[r].size(); i++) {
+      Operator::PrePost eff = ranges[r][i];
+      vector<int> effect;
+      effect.push_back(eff.var->get_index());
+      effect.push_back(eff.pre);
+      effect.push_back(eff.post);
+      vector<pair<int, int> > conds;
+      for(int j = 0; j < eff.effect_conds.size(); j++)
+	conds.push_back(make_pair(eff.effect_conds[j].var->get_index(),
+				  eff.effect_conds[j].cond));
+      sort(conds.begin(), conds.end());
+      effect.push_back(conds.size());
+      for(int j = 0; j < conds.size(); j++) {
+	effect.push_back(conds[j].first);
+	effect.push_back(conds[j].second);
+      }
+      if(r == 1) {
+	const OperatorArena::NumericEffect &num = op.get_numeric_effect(i);
+	append_expression(effect, arena, num.expression);
+	if(num.expression == -1) {
+	  int bits;
+	  memcpy(&bits, &num.f_cost, sizeof(bits));
+	  effect.push_back(bits);
+	}
+      }
+      effects.push_back(effect);
+    }
+  }
+  sort(effects.begin(), effects.end());
+  signature.push_back(effects.size());
+  for(int i = 0; i < effects.size(); i++) {
+    signature.push_back(effects[i].size());
+    signature.insert(signature.end(), effects[i].begin(), effects[i].end());
+  }
+
+  signature.push_back(op.get_cost_kind());
+  append_expression(signature, arena, op.get_cost_expression());
+}
+
+void dedup_operators(vector<Operator> &operators,
+		     vector<pair<string, string> > &removed) {
+  int old_count = operators.size();
+  SignatureTable signatures;
+  vector<int> kept_of_class; // operator kept for each signature
+  vector<int> class_of_op(operators.size());
+  vector<int> signature;
+  for(int i = 0; i < operators.size(); i++) {
+    signature.clear();
+    append_operator_signature(signature, operators[i]);
+    int id = signatures.intern(signature);
+    class_of_op[i] = id;
+    if(id == kept_of_class.size())
+      kept_of_class.push_back(i);
+    else if(operators[i].get_cost() < operators[kept_of_class[id]].get_cost())
+      kept_of_class[id] = i;
+  }
+
+  int new_index = 0;
+  for(int i = 0; i < operators.size(); i++) {
+    int kept = kept_of_class[class_of_op[i]];
+    if(kept == i)
+      operators[new_index++] = operators[i];
+    else
+      removed.push_back(make_pair(operators[i].get_name(),
+				  operators[kept].get_name()));
+  }
+  operators.erase(operators.begin() + new_index, operators.end());
+  cout << operators.size() << " of " << old_count
+       << " operators left after removing duplicates." << endl;
+}
+
+void dedup_axioms(vector<Axiom> &axioms) {
+  int old_count = axioms.size();
+  SignatureTable signatures;
+  int num_classes = 0;
+  int new_index = 0;
+  vector<pair<int, int> > conds;
+  vector<int> signature;
+  for(int i = 0; i < axioms.size(); i++) {
+    const Axiom &axiom = axioms[i];
+    conds.clear();
+    for(int j = 0; j < axiom.get_conditions().size(); j++)
+      conds.push_back(make_pair(axiom.get_conditions()[j].var->get_index(),
+				axiom.get_conditions()[j].cond));
+    sort(conds.begin(), conds.end());
+    signature.clear();
+    signature.push_back(axiom.get_effect_var()->get_index());
+    signature.push_back(axiom.get_old_val());
+    signature.push_back(axiom.get_effect_val());
+    for(int j = 0; j < conds.size(); j++) {
+      signature.push_back(conds[j].first);
+      signature.push_back(conds[j].second);
+    }
+    if(signatures.intern(signature) == num_classes) {
+      num_classes++;
+      axioms[new_index++] = axioms[i];
+    }
+  }
+  axioms.erase(axioms.begin() + new_index, axioms.end());
+  cout << axioms.size() << " of " << old_count
+       << " axiom rules left after removing duplicates." << endl;
+}
+
+// Orders operators by number of preconditions, then cost, then index, so
+// that any operator that dominates another one comes before it.
+class DominanceOrder {
+  const vector<int> &pre_begin;
+  const vector<Operator> &operators;
+public:
+  DominanceOrder(const vector<int> &begin, const vector<Operator> &ops)
+    : pre_begin(begin), operators(ops) {}
+  bool operator()(int op1, int op2) const {
+    int size1 = pre_begin[op1 + 1] - pre_begin[op1];
+    int size2 = pre_begin[op2 + 1] - pre_begin[op2];
+    if(size1 != size2)
+      return size1 < size2;
+    if(operators[op1].get_cost() != operators[op2].get_cost())
+      return operators[op1].get_cost() < operators[op2].get_cost();
+    return op1 < op2;
+  }
+};
+
+void prune_dominated_operators(vector<Operator> &operators,
+			       const FactIndex &facts,
+			       vector<pair<string, string> > &removed) {
+  int old_count = operators.size();
+  // Preconditions of operator i as sorted fact IDs are
+  // [pre_begin[i], pre_begin[i + 1]) in pre_facts.
+  vector<int> pre_facts;
+  vector<int> pre_begin(1, 0);
+  SignatureTable effect_signatures;
+  vector<vector<int> > buckets; // operators by effect signature
+  vector<int> pre;
+  vector<pair<int, int> > effects;
+  vector<int> signature;
+  for(int i = 0; i < operators.size(); i++) {
+    const Operator &op = operators[i];
+    if(op.has_numeric_effects() || op.has_blocking_effects() ||
+       op.has_conditional_effects() || op.get_cost_kind() != Operator::NO_RUNTIME_COST) {
+      pre_begin.push_back(pre_facts.size());
+      continue;
+    }
+    pre.clear();
+    for(int j = 0; j < op.get_prevail().size(); j++) {
+      Operator::Prevail prev = op.get_prevail()[j];
+      pre.push_back(facts.get_fact(prev.var, prev.prev));
+    }
+    effects.clear();
+    Operator::PrePostRange pre_post = op.get_propositional_effects();
+    for(int j = 0; j < pre_post.size(); j++) {
+      Operator::PrePost eff = pre_post[j];
+      if(eff.pre != PRE_ANY)
+	pre.push_back(facts.get_fact(eff.var, eff.pre));
+      effects.push_back(make_pair(eff.var->get_index(), eff.post));
+    }
+    sort(pre.begin(), pre.end());
+    pre.erase(unique(pre.begin(), pre.end()), pre.end());
+    pre_facts.insert(pre_facts.end(), pre.begin(), pre.end());
+    pre_begin.push_back(pre_facts.size());
+
+    sort(effects.begin(), effects.end());
+    signature.clear();
+    for(int j = 0; j < effects.size(); j++) {
+      signature.push_back(effects[j].first);
+      signature.push_back(effects[j].second);
+    }
+    int bucket = effect_signatures.intern(signature);
+    if(bucket == buckets.size())
+      buckets.push_back(vector<int>());
+    buckets[bucket].push_back(i);
+  }
+
+  // A dominated operator is only tested against kept operators: if its
+  // dominator is dominated in turn, the operator dominating that one
+  // also dominates it.
+  vector<int> dominated_by(operators.size(), -1);
+  vector<int> kept;
+  for(int b = 0; b < buckets.size(); b++) {
+    vector<int> &bucket = buckets[b];
+    sort(bucket.begin(), bucket.end(), DominanceOrder(pre_begin, operators));
+    kept.clear();
+    for(int j = 0; j < bucket.size(); j++) {
+      int op = bucket[j];
+      for(int k = 0; k < kept.size(); k++) {
+	int other = kept[k];
+	if(operators[other].get_cost() <= operators[op].get_cost() &&
+	   includes(pre_facts.begin() + pre_begin[op],
+		    pre_facts.begin() + pre_begin[op + 1],
+		    pre_facts.begin() + pre_begin[other],
+		    pre_facts.begin() + pre_begin[other + 1])) {
+	  dominated_by[op] = other;
+	  break;
+	}
+      }
+      if(dominated_by[op] == -1)
+	kept.push_back(op);
+    }
+  }
+
+  int new_index = 0;
+  for(int i = 0; i < operators.size(); i++) {
+    if(dominated_by[i] == -1)
+      operators[new_index++] = operators[i];
+    else
+      removed.push_back(make_pair(operators[i].get_name(),
+				  operators[dominated_by[i]].get_name()));
+  }
+  operators.erase(operators.begin() + new_index, operators.end());
+  cout << operators.size() << " of " << old_count
+       << " operators left after removing dominated operators." << endl;
+}
+
+void write_removed_operators(const string &file_name,
+			     const vector<pair<string, string> > &removed) {
+  ofstream outfile;
+  outfile.open(file_name.c_str(), ios::out);
+  outfile << "begin_removed_operators" << endl;
+  outfile << removed.size() << endl;
+  for(int i = 0; i < removed.size(); i++) {
+    outfile << removed[i].first << endl;
+    outfile << removed[i].second << endl;
+  }
+  outfile << "end_removed_operators" << endl;
+  outfile.close();
+}
@@ -0,0 +1,78 @@
+/*********************************************************************
+ * This file is part of LAMA.
+ *
+ * LAMA is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the license, or (at your option) any later version.
+ *
+ * LAMA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ *********************************************************************/
+
+#ifndef DEDUP_H
+#define DEDUP_H
+
+/*
+  Removal of duplicate operators and axiom rules after stripping.
+
+  Two operators are duplicates if they have the same prevail conditions,
+  the same effects (with the same effect conditions and numeric effect
+  costs) and the same kind of cost with the same runtime cost or module
+  call, irrespective of the order in which conditions and effects are
+  listed. Only the cost value may differ. Of each set of duplicates the
+  one with the lowest cost (the first of those on a tie) is kept in its
+  place, and the others are removed. Axiom rules are duplicates if they
+  have the same conditions and effect; the first one is kept.
+
+  With --prune-dominated, operators dominated by another one are removed
+  as well. Operator o1 dominates o2 if both have the same effects, the
+  preconditions (prevail conditions and effect preconditions) of o1 are a
+  subset of those of o2 and o1 costs no more than o2; o1 can then always
+  be used instead of o2. Only operators with unconditional propositional
+  effects and a static cost take part: numeric, blocking and conditional
+  effects and runtime or module costs are left alone. Operators are
+  grouped by their effects, and within a group each operator is tested
+  against the kept ones with fewer or equal preconditions.
+
+  The removed operators are listed in a side file for plan reconstruction,
+  <output>_dedup for duplicates and <output>_dominated for dominated
+  operators:
+
+    begin_removed_operators
+    <number of removed operators>
+    <name of removed operator>
+    <name of the (kept) operator used instead>
+    ...
+    end_removed_operators
+*/
+
+#include <string>
+#include <vector>
+using namespace std;
+
+class Operator;
+class Axiom;
+class FactIndex;
+
+extern bool g_dedup;
+extern bool g_prune_dominated;
+
+// Fills removed with the (removed, kept) operator names.
+extern void dedup_operators(vector<Operator> &operators,
+			    vector<pair<string, string> > &removed);
+extern void dedup_axioms(vector<Axiom> &axioms);
+// Fills removed with the (removed, dominating) operator names.
+extern void prune_dominated_operators(vector<Operator> &operators,
+				      const FactIndex &facts,
+				      vector<pair<string, string> > &removed);
+extern void write_removed_operators(const string &file_name,
+				    const vector<pair<string, string> > &removed);
+
+#endif
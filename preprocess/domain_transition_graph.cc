@@ -34,188 +34,522 @@
 #include "axiom.h"
 #include "variable.h"
 #include "scc.h"
+#include "fact_index.h"
+#include "parallel.h"
 
 #include <algorithm>
 #include <cassert>
+#include <functional>
 #include <iostream>
+#include <queue>
 using namespace std;
 
-DomainTransitionGraph::DomainTransitionGraph(const Variable &var) {
+bool g_compact_wildcard_transitions = false;
+bool g_merge_dtg_transitions = false;
+bool g_cheapest_dtg_transitions = false;
+bool g_dtg_distances = false;
+
+DomainTransitionGraph::DomainTransitionGraph(const Variable &var,
+					     const ConditionPool &conditions)
+  : pool(&conditions) {
   vertices.resize(var.get_range());
   level = var.get_level();
   assert(level != -1);
+  derived = var.is_derived();
+}
+
+void DomainTransitionGraph::addTransition(int from, int to, int op_index,
+					  ConditionID condition) {
+  Transition trans(to, op_index, condition);
+  // The transitioin is added to the vertice "from" in this transition graph
+  // (or stored once as a wildcard transition if it applies to any value)
+  if(from == -1)
+    wildcard_transitions.push_back(trans);
+  else
+    vertices[from].push_back(trans);
+}
+
+bool DomainTransitionGraph::is_cheaper(const vector<Operator> &operators,
+				       int op1, int op2) const {
+  // Transitions of derived variables come from axioms, which are free.
+  return g_cheapest_dtg_transitions && !derived &&
+    operators[op1].get_cost() < operators[op2].get_cost();
+}
+
+void DomainTransitionGraph::merge_equal_transitions(
+  vector<Transition> &transitions, const vector<Operator> &operators,
+  EdgeMap &edges) {
+  // Merged transitions stay at the position of their first occurrence.
+  edges.clear();
+  vector<Transition> merged;
+  vector<vector<int> > ops;
+  for(int j = 0; j < transitions.size(); j++) {
+    const Transition &trans = transitions[j];
+    pair<EdgeMap::iterator, bool> entry = edges.insert(
+      make_pair(make_pair(trans.target, trans.condition), int(merged.size())));
+    if(entry.second) {
+      merged.push_back(trans);
+      ops.push_back(vector<int>(1, trans.op));
+    } else {
+      Transition &edge = merged[entry.first->second];
+      ops[entry.first->second].push_back(trans.op);
+      if(is_cheaper(operators, trans.op, edge.op))
+	edge.op = trans.op;
+    }
+  }
+  if(g_merge_dtg_transitions) {
+    for(int j = 0; j < merged.size(); j++) {
+      if(ops[j].size() == 1)
+	continue;
+      sort(ops[j].begin(), ops[j].end());
+      ops[j].erase(unique(ops[j].begin(), ops[j].end()), ops[j].end());
+      merged[j].supporters = supporting_ops.size();
+      supporting_ops.push_back(ops[j]);
+    }
+  }
+  transitions.swap(merged);
+}
+
+void DomainTransitionGraph::merge_transitions(const vector<Operator> &operators) {
+  EdgeMap wildcard_edges, edges;
+  merge_equal_transitions(wildcard_transitions, operators, wildcard_edges);
+  for(int i = 0; i < vertices.size(); i++) {
+    merge_equal_transitions(vertices[i], operators, edges);
+    for(int j = 0; j < vertices[i].size(); j++) {
+      Transition &trans = vertices[i][j];
+      if(trans.target == i)
+	continue;
+      EdgeMap::const_iterator wildcard =
+	wildcard_edges.find(make_pair(trans.target, trans.condition));
+      if(wildcard == wildcard_edges.end())
+	continue;
+      // finalize() suppresses this wildcard here, so its operators go to
+      // the transition that dominates it.
+      const Transition &wild = wildcard_transitions[wildcard->second];
+      if(is_cheaper(operators, wild.op, trans.op))
+	trans.op = wild.op;
+      if(g_merge_dtg_transitions) {
+	vector<int> ops;
+	if(trans.supporters == -1)
+	  ops.push_back(trans.op);
+	else
+	  ops = supporting_ops[trans.supporters];
+	if(wild.supporters == -1)
+	  ops.push_back(wild.op);
+	else
+	  ops.insert(ops.end(), supporting_ops[wild.supporters].begin(),
+		     supporting_ops[wild.supporters].end());
+	sort(ops.begin(), ops.end());
+	ops.erase(unique(ops.begin(), ops.end()), ops.end());
+	trans.supporters = supporting_ops.size();
+	supporting_ops.push_back(ops);
+      }
+    }
+  }
 }
 
-void DomainTransitionGraph::addTransition(int from, int to, const Operator &op,
-					  int op_index) {
-  Transition trans(to, op_index);
-  Condition &cond = trans.condition;
-  const vector<Operator::Prevail> &prevail = op.get_prevail();
-  const vector<Operator::PrePost> &pre_post = op.get_pre_post();
+// Collects the condition of the transitions an operator induces in the DTG
+// of the given level: all prevail conditions and preconditions and the
+// effect conditions of that postcondition.
+static ConditionID intern_operator_condition(const Operator &op, int level,
+					     ConditionPool &conditions,
+					     vector<int> &cond) {
+  const FactIndex &facts = conditions.get_fact_index();
+  cond.clear();
+  Operator::PrevailRange prevail = op.get_prevail();
+  Operator::PrePostRange pre_post = op.get_propositional_effects();
   for(int i = 0; i < prevail.size(); i++)
     if(true) // [cycles]
     // if(prevail[i].var->get_level() < level) // [no cycles]
       // The first condition is the var and the prev state
-      cond.push_back(make_pair(prevail[i].var, prevail[i].prev));
+      cond.push_back(facts.get_fact(prevail[i].var, prevail[i].prev));
   for(int i = 0; i < pre_post.size(); i++)
-    if(pre_post[i].var->get_level() != level && pre_post[i].pre != -1 &&
-    		((pre_post[i].pre != -2) && (pre_post[i].pre != -3) && (pre_post[i].pre != -4) && (pre_post[i].pre != -5) && (pre_post[i].pre != -6))) // [cycles]
+    if(pre_post[i].var->get_level() != level && pre_post[i].pre != PRE_ANY) // [cycles]
     // if(pre_post[i].var->get_level() < level && pre_post[i].pre != -1) //[no cycles]
       // The other conditions are other prev states in the operator
-      cond.push_back(make_pair(pre_post[i].var, pre_post[i].pre));
+      cond.push_back(facts.get_fact(pre_post[i].var, pre_post[i].pre));
     else
       if(pre_post[i].var->get_level() == level && pre_post[i].is_conditional_effect)
 	for(int j = 0; j < pre_post[i].effect_conds.size(); j++)
-	  cond.push_back(make_pair(pre_post[i].effect_conds[j].var,
-				   pre_post[i].effect_conds[j].cond));
-
-  // The transitioin is added to the vertice "from" in this transition graph
-  vertices[from].push_back(trans);
+	  cond.push_back(facts.get_fact(pre_post[i].effect_conds[j].var,
+					pre_post[i].effect_conds[j].cond));
+  // Numeric effects only contribute their effect conditions.
+  if(op.has_numeric_effects() && op.has_conditional_effects()) {
+    Operator::PrePostRange numeric = op.get_numeric_effects();
+    for(int i = 0; i < numeric.size(); i++)
+      if(numeric[i].var->get_level() == level)
+	for(int j = 0; j < numeric[i].effect_conds.size(); j++)
+	  cond.push_back(facts.get_fact(numeric[i].effect_conds[j].var,
+					numeric[i].effect_conds[j].cond));
+  }
+  return conditions.intern(cond);
 }
-void DomainTransitionGraph::addAxTransition(int from, int to, const Axiom &ax,
-					    int ax_index) {
-  Transition trans(to, ax_index);
-  Condition &cond = trans.condition;
+
+static ConditionID intern_axiom_condition(const Axiom &ax,
+					  ConditionPool &conditions,
+					  vector<int> &cond) {
+  const FactIndex &facts = conditions.get_fact_index();
+  cond.clear();
   const vector<Axiom::Condition> &ax_conds = ax.get_conditions();
   for(int i = 0; i < ax_conds.size(); i++)
     if(true) // [cycles]
     // if(prevail[i].var->get_level() < level) // [no cycles]
-      cond.push_back(make_pair(ax_conds[i].var, ax_conds[i].cond));
-  vertices[from].push_back(trans);
+      cond.push_back(facts.get_fact(ax_conds[i].var, ax_conds[i].cond));
+  return conditions.intern(cond);
 }
 
-bool DomainTransitionGraph::Transition::operator<(const Transition &other) const {
-  if (target != other.target)
-    return target < other.target;
-  else
-    return condition.size() < other.condition.size();
+/* Index over the condition sets of the transitions kept so far for one
+ * target. Candidates are visited in order of increasing condition size, so
+ * a candidate is dominated iff some kept set is a subset of it. A kept set
+ * with the same ID is found directly; otherwise, for each kept set that
+ * shares a fact with the candidate, we count how many of its facts the
+ * candidate has, so only the sets containing the candidate's facts are
+ * ever touched.
+ */
+class SubsumptionIndex {
+  const ConditionPool &pool;
+  vector<vector<int> > sets_by_fact;
+  vector<int> used_facts;
+  vector<int> set_sizes;
+  vector<int> hits;
+  vector<int> touched_sets;
+  // IDs of the kept sets of the largest size so far; an equal set can
+  // only be among these.
+  vector<ConditionID> largest_kept;
+  bool has_empty_set;
+public:
+  SubsumptionIndex(const ConditionPool &conditions)
+    : pool(conditions),
+      sets_by_fact(conditions.get_fact_index().get_num_facts()),
+      has_empty_set(false) {}
+  bool contains_subset_of(ConditionID cond);
+  void add(ConditionID cond);
+  void clear();
+};
+
+bool SubsumptionIndex::contains_subset_of(ConditionID cond) {
+  if(has_empty_set)
+    return true;
+  if(find(largest_kept.begin(), largest_kept.end(), cond) != largest_kept.end())
+    return true;
+  bool found = false;
+  for(ConditionPool::const_iterator fact = pool.begin(cond);
+      !found && fact != pool.end(cond); ++fact) {
+    const vector<int> &sets = sets_by_fact[*fact];
+    for(int j = 0; j < sets.size(); j++) {
+      int set = sets[j];
+      if(hits[set]++ == 0)
+	touched_sets.push_back(set);
+      if(hits[set] == set_sizes[set]) {
+	found = true;
+	break;
+      }
+    }
+  }
+  for(int i = 0; i < touched_sets.size(); i++)
+    hits[touched_sets[i]] = 0;
+  touched_sets.clear();
+  return found;
+}
+
+void SubsumptionIndex::add(ConditionID cond) {
+  int size = pool.size(cond);
+  if(size == 0) {
+    has_empty_set = true;
+    return;
+  }
+  if(!set_sizes.empty() && set_sizes.back() != size)
+    largest_kept.clear();
+  largest_kept.push_back(cond);
+  int set = set_sizes.size();
+  set_sizes.push_back(size);
+  hits.push_back(0);
+  for(ConditionPool::const_iterator fact = pool.begin(cond);
+      fact != pool.end(cond); ++fact) {
+    vector<int> &sets = sets_by_fact[*fact];
+    if(sets.empty())
+      used_facts.push_back(*fact);
+    sets.push_back(set);
+  }
+}
+
+void SubsumptionIndex::clear() {
+  for(int i = 0; i < used_facts.size(); i++)
+    sets_by_fact[used_facts[i]].clear();
+  used_facts.clear();
+  set_sizes.clear();
+  hits.clear();
+  largest_kept.clear();
+  has_empty_set = false;
 }
 
 void DomainTransitionGraph::finalize() {
-  for(int i = 0; i < vertices.size(); i++) {
-    // For all sources, sort transitions according to targets and condition length
-    sort(vertices[i].begin(), vertices[i].end());
-    vertices[i].erase(unique(vertices[i].begin(), vertices[i].end()),
-		      vertices[i].end());
-    // For all transitions, sort conditions (acc. to pointer addresses)
-    for(int j = 0; j < vertices[i].size(); j++) {  
-      Transition &trans = vertices[i][j];
-      Condition &cond = trans.condition;
-      sort(cond.begin(), cond.end());
+  // A transition is dominated if another one from the same source has the
+  // same target and a subset of its conditions. Only the first of several
+  // transitions with equal conditions is kept.
+  SubsumptionIndex index(*pool);
+  TransitionOrder order(pool);
+
+  // Sort the transitions according to targets and condition length.
+  // Wildcard transitions exist for every source, so domination among
+  // them is checked once.
+  stable_sort(wildcard_transitions.begin(), wildcard_transitions.end(), order);
+  vector<Transition> undominated_trans;
+  for(int j = 0; j < wildcard_transitions.size(); j++) {
+    if(j == 0 || wildcard_transitions[j].target != wildcard_transitions[j - 1].target)
+      index.clear();
+    if(!index.contains_subset_of(wildcard_transitions[j].condition)) {
+      index.add(wildcard_transitions[j].condition);
+      undominated_trans.push_back(wildcard_transitions[j]);
     }
-    // Look for dominated transitions
-    vector<Transition> undominated_trans;
-    vector<bool> is_dominated;
-    is_dominated.resize(vertices[i].size(), false);
-    for(int j = 0; j < vertices[i].size(); j++) {
-      if(!is_dominated[j]) {
-	Transition &trans = vertices[i][j];
-	undominated_trans.push_back(trans);
-	Condition &cond = trans.condition;
-	int comp = j + 1; // compare transition no. j to no. comp
-	// comp is dominated if it has same target and same and more conditions
-	while(comp < vertices[i].size()) {
-	  if(is_dominated[comp]) {
-	    comp++;
-	    continue;
-	  }
-	  Transition &other_trans = vertices[i][comp];
-	  assert(other_trans.target >= trans.target);
-	  if(other_trans.target != trans.target)
-	    break; // transition and all after it have different targets
-	  else { //domination possible
-	    assert(other_trans.condition.size() >= cond.size());
-	    if(cond.size() == 0) {
-	      is_dominated[comp] = true; // comp is dominated
-	      comp++;
-	    }	      
-	    else {
-	      bool same_conditions = true;
-	      for(int k = 0; k < cond.size(); k++) {
-		bool cond_k = false;
-		for(int l = 0; l < other_trans.condition.size(); l++) {
-		  if(other_trans.condition[l].first > cond[k].first){
-		    break; // comp doesn't have this condition, not dominated
-		  }
-		  if(other_trans.condition[l].first == cond[k].first &&
-		     other_trans.condition[l].second == cond[k].second) {
-		    cond_k = true;
-		    break; // comp has this condition, look for next cond
-		  }
-		}
-		if(!cond_k) { // comp is not dominated
-		  same_conditions = false; 
-		  break;
-		}
-	      }
-	      is_dominated[comp] = same_conditions;
-	      comp++;
-	    }
-	  }
+  }
+  wildcard_transitions.swap(undominated_trans);
+
+  suppressed_wildcards.clear();
+  suppressed_wildcards.resize(vertices.size());
+  for(int i = 0; i < vertices.size(); i++) {
+    Vertex &vertex = vertices[i];
+    stable_sort(vertex.begin(), vertex.end(), order);
+    // Look for dominated transitions, one target at a time. Wildcard
+    // transitions to the same target take part in the comparison, in the
+    // order in which they are written when expanded.
+    undominated_trans.clear();
+    int k = 0;
+    for(int j = 0; j < vertex.size();) {
+      int target = vertex[j].target;
+      int group_end = j;
+      while(group_end < vertex.size() && vertex[group_end].target == target)
+	group_end++;
+      while(k < wildcard_transitions.size() && wildcard_transitions[k].target < target)
+	k++;
+      index.clear();
+      while(j < group_end) {
+	bool take_wildcard = target != i && k < wildcard_transitions.size() &&
+	  wildcard_transitions[k].target == target &&
+	  order(wildcard_transitions[k], vertex[j]);
+	ConditionID cond = take_wildcard ? wildcard_transitions[k].condition
+	                                 : vertex[j].condition;
+	bool dominated = index.contains_subset_of(cond);
+	if(!dominated)
+	  index.add(cond);
+	if(take_wildcard) {
+	  if(dominated)
+	    suppressed_wildcards[i].push_back(k);
+	  k++;
+	} else {
+	  if(!dominated)
+	    undominated_trans.push_back(vertex[j]);
+	  j++;
 	}
       }
+      // Remaining wildcards for this target cannot dominate anything left.
+      while(target != i && k < wildcard_transitions.size() &&
+	    wildcard_transitions[k].target == target) {
+	if(index.contains_subset_of(wildcard_transitions[k].condition))
+	  suppressed_wildcards[i].push_back(k);
+	k++;
+      }
     }
+    vertex.swap(undominated_trans);
   }
 }
 
-void build_DTGs(const vector<Variable *> &var_order,
-		const vector<Operator> &operators,
-		const vector<Axiom> &axioms,
-		vector<DomainTransitionGraph> &transition_graphs) {
-  // For each var a transition graph is created
-  for(int i = 0; i < var_order.size(); i++) {
-    transition_graphs.push_back(DomainTransitionGraph(*var_order[i]));
-  }
+void build_DTG_sources(const vector<Variable *> &var_order,
+		       const vector<Operator> &operators,
+		       const vector<Axiom> &axioms,
+		       ConditionPool &conditions,
+		       DTGSources &sources) {
+  sources.effects_by_var.clear();
+  sources.effects_by_var.resize(var_order.size());
+  sources.axioms_by_var.clear();
+  sources.axioms_by_var.resize(var_order.size());
 
+  vector<int> cond;
   // For each operator
   for(int i = 0; i < operators.size(); i++) {
-    const Operator &op = operators[i];
-    // For each effect
-    const vector<Operator::PrePost> &pre_post = op.get_pre_post();
+    // For each (non-numeric) effect
+    Operator::PrePostRange pre_post = operators[i].get_propositional_effects();
     for(int j = 0; j < pre_post.size(); j++) {
-    	//If the varable has been explored
-      const Variable *var = pre_post[j].var;
-      int var_level = var->get_level();
-      if((var_level != -1) && (pre_post[j].pre != -2 and
-    		  pre_post[j].pre != -3 and pre_post[j].pre != -4 and pre_post[j].pre != -5 and pre_post[j].pre != -6)) {
-    // Get pre and post
-	int pre = pre_post[j].pre;
-	int post = pre_post[j].post;
-	// If pre is not a non state
-	// Transition graphs are indexed by variable but ordered by importance
-	if(pre != -1) {
-	  transition_graphs[var_level].addTransition(pre, post, op, i);
-	} else {
-	  for(int pre = 0; pre < var->get_range(); pre++)
-	    if(pre != post)
-	      transition_graphs[var_level].addTransition(pre, post, op, i);
-	}
-      }
+      //If the varable has been explored
+      int var_level = pre_post[j].var->get_level();
+      if(var_level != -1)
+	sources.effects_by_var[var_level].push_back(DTGEffectSource(
+	  i, j, intern_operator_condition(operators[i], var_level, conditions, cond)));
       //else
 	 //cout <<"leave out var "<< var->get_name()<<" (unimportant) " << endl;
     }
   }
   for(int i = 0; i < axioms.size(); i++) {
-    const Axiom &ax = axioms[i];
-    Variable *var = ax.get_effect_var();
-    int var_level = var->get_level();
+    int var_level = axioms[i].get_effect_var()->get_level();
     assert(var_level != -1);
-    int old_val = ax.get_old_val();
-    int new_val = ax.get_effect_val();
-    transition_graphs[var_level].addAxTransition(old_val, new_val, ax, i);
-  }    
+    sources.axioms_by_var[var_level].push_back(
+      make_pair(i, intern_axiom_condition(axioms[i], conditions, cond)));
+  }
+}
 
-  for(int i = 0; i < transition_graphs.size(); i++)
-    transition_graphs[i].finalize();
+void build_DTG(const Variable &var,
+	       const vector<Operator> &operators,
+	       const vector<Axiom> &axioms,
+	       const DTGSources &sources,
+	       DomainTransitionGraph &transition_graph) {
+  int var_level = var.get_level();
+  const vector<DTGEffectSource> &effects = sources.effects_by_var[var_level];
+  for(int i = 0; i < effects.size(); i++) {
+    const Operator &op = operators[effects[i].op];
+    Operator::PrePost pre_post = op.get_propositional_effects()[effects[i].effect];
+    // Get pre and post; pre == -1 becomes a single wildcard transition
+    transition_graph.addTransition(pre_post.pre, pre_post.post,
+				   effects[i].op, effects[i].condition);
+  }
+  const vector<pair<int, ConditionID> > &ax_sources = sources.axioms_by_var[var_level];
+  for(int i = 0; i < ax_sources.size(); i++) {
+    const Axiom &ax = axioms[ax_sources[i].first];
+    transition_graph.addTransition(ax.get_old_val(), ax.get_effect_val(),
+				   ax_sources[i].first, ax_sources[i].second);
+  }
+  if(g_merge_dtg_transitions || g_cheapest_dtg_transitions)
+    transition_graph.merge_transitions(operators);
+  transition_graph.finalize();
+}
+
+// The DTGs of var_order[first], var_order[first + 1], ... are built into
+// graphs[0], graphs[1], ..., one variable per parallel_for index.
+struct DTGBuildJob {
+  const vector<Variable *> *var_order;
+  const vector<Operator> *operators;
+  const vector<Axiom> *axioms;
+  const DTGSources *sources;
+  int first;
+  DomainTransitionGraph *graphs;
+  // Strong connectivity is checked for variables below this level.
+  int check_below;
+  char *connected;
+  // Indexed by level, not relative to first; null if not wanted.
+  DTGDistanceTable *distances;
+};
+
+static void build_DTG_job(int i, void *data) {
+  DTGBuildJob *job = static_cast<DTGBuildJob *>(data);
+  DomainTransitionGraph &graph = job->graphs[i - job->first];
+  build_DTG(*(*job->var_order)[i], *job->operators, *job->axioms,
+	    *job->sources, graph);
+  if(i < job->check_below)
+    job->connected[i - job->first] = graph.is_strongly_connected();
+  if(job->distances)
+    graph.compute_distances(*job->operators, job->distances[i]);
 }
+
+void build_DTGs(const vector<Variable *> &var_order,
+		const vector<Operator> &operators,
+		const vector<Axiom> &axioms,
+		ConditionPool &conditions,
+		vector<DomainTransitionGraph> &transition_graphs,
+		vector<DTGDistanceTable> *distances) {
+  DTGSources sources;
+  build_DTG_sources(var_order, operators, axioms, conditions, sources);
+  // For each var a transition graph is created
+  // Transition graphs are indexed by variable but ordered by importance
+  transition_graphs.reserve(var_order.size());
+  for(int i = 0; i < var_order.size(); i++)
+    transition_graphs.push_back(DomainTransitionGraph(*var_order[i], conditions));
+  if(transition_graphs.empty())
+    return;
+
+  DTGBuildJob job;
+  job.var_order = &var_order;
+  job.operators = &operators;
+  job.axioms = &axioms;
+  job.sources = &sources;
+  job.first = 0;
+  job.graphs = &transition_graphs[0];
+  job.check_below = 0;
+  job.connected = 0;
+  job.distances = 0;
+  if(distances) {
+    distances->resize(var_order.size());
+    job.distances = &(*distances)[0];
+  }
+  parallel_for(0, var_order.size(), &build_DTG_job, &job);
+}
+
+bool generate_DTGs_streaming(ostream &outfile,
+			     const vector<Variable *> &var_order,
+			     const vector<Operator> &operators,
+			     const vector<Axiom> &axioms,
+			     ConditionPool &conditions,
+			     bool check_connectivity,
+			     vector<DTGDistanceTable> *distances) {
+  DTGSources sources;
+  build_DTG_sources(var_order, operators, axioms, conditions, sources);
+
+  DTGBuildJob job;
+  job.var_order = &var_order;
+  job.operators = &operators;
+  job.axioms = &axioms;
+  job.sources = &sources;
+  // no need to test last variable's dtg (highest level variable)
+  job.check_below = check_connectivity ? int(var_order.size()) - 1 : 0;
+  job.distances = 0;
+  if(distances && !var_order.empty()) {
+    distances->resize(var_order.size());
+    job.distances = &(*distances)[0];
+  }
+
+  // Only one graph per thread is alive at a time: each window of
+  // variables is built in parallel, written in order and freed.
+  int window_size = g_num_threads > 1 ? g_num_threads : 1;
+  vector<DomainTransitionGraph> window;
+  vector<char> connected(window_size, true);
+  bool all_connected = true;
+  for(int first = 0; first < var_order.size(); first += window_size) {
+    int last = min(first + window_size, int(var_order.size()));
+    for(int i = first; i < last; i++)
+      window.push_back(DomainTransitionGraph(*var_order[i], conditions));
+    job.first = first;
+    job.graphs = &window[0];
+    job.connected = &connected[0];
+    parallel_for(first, last, &build_DTG_job, &job);
+
+    for(int i = first; i < last; i++) {
+      if(i < job.check_below && !connected[i - first])
+	all_connected = false;
+      outfile << "begin_DTG" << endl;
+      window[i - first].generate_cpp_input(outfile);
+      outfile << "end_DTG" << endl;
+      // Release the sources of this variable as well.
+      vector<DTGEffectSource>().swap(sources.effects_by_var[i]);
+      vector<pair<int, ConditionID> >().swap(sources.axioms_by_var[i]);
+    }
+    window.clear();
+  }
+  return check_connectivity && all_connected;
+}
+
+struct DTGConnectivityJob {
+  const vector<DomainTransitionGraph> *transition_graphs;
+  vector<char> connected;
+};
+
+static void check_DTG_connectivity_job(int i, void *data) {
+  DTGConnectivityJob *job = static_cast<DTGConnectivityJob *>(data);
+  job->connected[i] = (*job->transition_graphs)[i].is_strongly_connected();
+}
+
 bool are_DTGs_strongly_connected(const vector<DomainTransitionGraph> &transition_graphs) {
-  bool connected = true;
   // no need to test last variable's dtg (highest level variable)
-  for(int i = 0; i < transition_graphs.size() - 1; i++)
-    if(!transition_graphs[i].is_strongly_connected())
-      connected = false;
-  return connected;
+  int num_checked = int(transition_graphs.size()) - 1;
+  if(num_checked <= 0)
+    return true;
+  DTGConnectivityJob job;
+  job.transition_graphs = &transition_graphs;
+  job.connected.resize(num_checked, false);
+  parallel_for(0, num_checked, &check_DTG_connectivity_job, &job);
+  for(int i = 0; i < num_checked; i++)
+    if(!job.connected[i])
+      return false;
+  return true;
 }
+
 bool DomainTransitionGraph::is_strongly_connected() const {
   vector<vector<int> > easy_graph;
   for(int i = 0; i < vertices.size(); i++) {
@@ -226,6 +560,17 @@ bool DomainTransitionGraph::is_strongly_connected() const {
       easy_graph[i].push_back(trans.target);
     }
   }
+  if(!wildcard_transitions.empty()) {
+    // A wildcard transition leads from every value to its target. Route
+    // these through one extra hub vertex instead of adding range many arcs
+    // per transition; this does not change reachability between values.
+    int hub = vertices.size();
+    easy_graph.push_back(vector<int>());
+    for(int i = 0; i < vertices.size(); i++)
+      easy_graph[i].push_back(hub);
+    for(int j = 0; j < wildcard_transitions.size(); j++)
+      easy_graph[hub].push_back(wildcard_transitions[j].target);
+  }
   vector<vector<int> > sccs = SCC(easy_graph).get_result();
  //  cout << "easy graph sccs for var " << level << endl;
 //   for(int i = 0; i < sccs.size(); i++) {
@@ -241,39 +586,219 @@ bool DomainTransitionGraph::is_strongly_connected() const {
   //else cout << "not strongly connected" << endl;
   return connected;
 }
+// Cost of the cheapest operator inducing the transition, at least 0.
+double DomainTransitionGraph::get_cost(const vector<Operator> &operators,
+				       const Transition &trans) const {
+  if(derived)
+    return 0;
+  double cost = operators[trans.op].get_cost();
+  if(trans.supporters != -1) {
+    const vector<int> &ops = supporting_ops[trans.supporters];
+    for(int i = 0; i < ops.size(); i++)
+      cost = min(cost, double(operators[ops[i]].get_cost()));
+  }
+  return max(0.0, cost);
+}
+
+void DomainTransitionGraph::compute_distances(const vector<Operator> &operators,
+					      DTGDistanceTable &table) const {
+  int range = vertices.size();
+  table.range = range;
+  table.steps.assign(range * range, -1);
+  table.cost.assign(range * range, -1);
+
+  // Arcs with the cost of their cheapest transition, as written in the
+  // expanded format: own transitions plus the wildcards to other values
+  // that are not dominated at this source. Transitions of derived
+  // variables are axioms, which are free.
+  vector<vector<pair<int, double> > > arcs(range);
+  vector<double> best(range);
+  for(int i = 0; i < range; i++) {
+    best.assign(range, -1);
+    for(int j = 0; j < vertices[i].size(); j++) {
+      const Transition &trans = vertices[i][j];
+      double cost = get_cost(operators, trans);
+      if(trans.target != i && (best[trans.target] < 0 || cost < best[trans.target]))
+	best[trans.target] = cost;
+    }
+    const vector<int> &suppressed = suppressed_wildcards[i];
+    for(int k = 0; k < wildcard_transitions.size(); k++) {
+      const Transition &trans = wildcard_transitions[k];
+      if(trans.target == i ||
+	 binary_search(suppressed.begin(), suppressed.end(), k))
+	continue;
+      double cost = get_cost(operators, trans);
+      if(best[trans.target] < 0 || cost < best[trans.target])
+	best[trans.target] = cost;
+    }
+    for(int j = 0; j < range; j++)
+      if(best[j] >= 0)
+	arcs[i].push_back(make_pair(j, best[j]));
+  }
+
+  vector<int> queue;
+  typedef pair<double, int> Entry;
+  for(int source = 0; source < range; source++) {
+    int *steps = &table.steps[source * range];
+    double *cost = &table.cost[source * range];
+
+    // Fewest transitions by breadth-first search.
+    queue.clear();
+    queue.push_back(source);
+    steps[source] = 0;
+    for(int head = 0; head < queue.size(); head++) {
+      int value = queue[head];
+      for(int j = 0; j < arcs[value].size(); j++) {
+	int target = arcs[value][j].first;
+	if(steps[target] == -1) {
+	  steps[target] = steps[value] + 1;
+	  queue.push_back(target);
+	}
+      }
+    }
+
+    // Cheapest paths by Dijkstra's algorithm.
+    priority_queue<Entry, vector<Entry>, greater<Entry> > open;
+    vector<char> closed(range, false);
+    cost[source] = 0;
+    open.push(Entry(0, source));
+    while(!open.empty()) {
+      Entry entry = open.top();
+      open.pop();
+      int value = entry.second;
+      if(closed[value])
+	continue;
+      closed[value] = true;
+      for(int j = 0; j < arcs[value].size(); j++) {
+	int target = arcs[value][j].first;
+	double new_cost = entry.first + arcs[value][j].second;
+	if(cost[target] < 0 || new_cost < cost[target]) {
+	  cost[target] = new_cost;
+	  open.push(Entry(new_cost, target));
+	}
+      }
+    }
+  }
+}
+
+void generate_DTG_distances(ostream &outfile,
+			    const vector<DTGDistanceTable> &distances) {
+  outfile << "begin_DTG_distances" << endl;
+  outfile << distances.size() << endl;
+  streamsize old_precision = outfile.precision(17);
+  for(int i = 0; i < distances.size(); i++) {
+    const DTGDistanceTable &table = distances[i];
+    int range = table.range;
+    outfile << range << endl;
+    for(int j = 0; j < range; j++) {
+      for(int k = 0; k < range; k++)
+	outfile << (k ? " " : "") << table.steps[j * range + k];
+      outfile << endl;
+    }
+    for(int j = 0; j < range; j++) {
+      for(int k = 0; k < range; k++)
+	outfile << (k ? " " : "") << table.cost[j * range + k];
+      outfile << endl;
+    }
+  }
+  outfile.precision(old_precision);
+  outfile << "end_DTG_distances" << endl;
+}
+
+void DomainTransitionGraph::dump_transition(const Transition &trans) const {
+  const FactIndex &facts = pool->get_fact_index();
+  cout << "    " << "To value " << trans.target << endl;
+  for(ConditionPool::const_iterator fact = pool->begin(trans.condition);
+      fact != pool->end(trans.condition); ++fact)
+    cout << "      if " << facts.get_variable(*fact)->get_name()
+	 << " = " << facts.get_value(*fact) << endl;
+}
+
 void DomainTransitionGraph::dump() const {
   cout << "Level: " << level << endl;
   for(int i = 0; i < vertices.size(); i++) {
     cout << "  From value " << i << ":" << endl;
-    for(int j = 0; j < vertices[i].size(); j++) {
-      const Transition &trans = vertices[i][j];
-      cout << "    " << "To value " << trans.target << endl;
-      for(int k = 0; k < trans.condition.size(); k++)
-	cout << "      if " << trans.condition[k].first->get_name()
-	     << " = " << trans.condition[k].second << endl;
-    }
+    for(int j = 0; j < vertices[i].size(); j++)
+      dump_transition(vertices[i][j]);
+  }
+  cout << "  From any other value:" << endl;
+  for(int j = 0; j < wildcard_transitions.size(); j++)
+    dump_transition(wildcard_transitions[j]);
+}
+
+void DomainTransitionGraph::generate_transition(ostream &outfile,
+						const Transition &trans) const {
+  const FactIndex &facts = pool->get_fact_index();
+  ConditionPool::const_iterator begin = pool->begin(trans.condition);
+  ConditionPool::const_iterator end = pool->end(trans.condition);
+  outfile << trans.target << endl;  // target of transition
+  // operator(s) doing the transition
+  if(!g_merge_dtg_transitions) {
+    outfile << trans.op << endl;
+  } else if(trans.supporters == -1) {
+    outfile << 1 << " " << trans.op << endl;
+  } else {
+    const vector<int> &ops = supporting_ops[trans.supporters];
+    outfile << ops.size();
+    for(int i = 0; i < ops.size(); i++)
+      outfile << " " << ops[i];
+    outfile << endl;
+  }
+  // calculate number of important prevail conditions
+  int number = 0;
+  for(ConditionPool::const_iterator fact = begin; fact != end; ++fact)
+    if(facts.get_variable(*fact)->get_level() != -1)
+      number++;
+  outfile << number << endl; 
+  for(ConditionPool::const_iterator fact = begin; fact != end; ++fact) {
+    const Variable *var = facts.get_variable(*fact);
+    if(var->get_level() != -1)
+      outfile << var->get_level() <<
+	" " << facts.get_value(*fact) << endl; // condition: var, val
   }
 }
 
-void DomainTransitionGraph::generate_cpp_input(ofstream &outfile) const {
+void DomainTransitionGraph::generate_cpp_input(ostream &outfile) const {
   //outfile << vertices.size() << endl; // the variable's range
+  if(g_compact_wildcard_transitions) {
+    for(int i = 0; i < vertices.size(); i++) {
+      outfile << vertices[i].size() << endl; // number of transitions from this value
+      for(int j = 0; j < vertices[i].size(); j++)
+	generate_transition(outfile, vertices[i][j]);
+    }
+    // Transitions applicable from every value other than their target;
+    // the search expands them when it needs them.
+    outfile << "wildcard_transitions " << wildcard_transitions.size() << endl;
+    for(int j = 0; j < wildcard_transitions.size(); j++)
+      generate_transition(outfile, wildcard_transitions[j]);
+    return;
+  }
+
+  // Backward compatible format: expand the wildcard transitions into every
+  // source value, merged into that value's sorted transition list.
+  TransitionOrder order(pool);
   for(int i = 0; i < vertices.size(); i++) {
-    outfile << vertices[i].size() << endl; // number of transitions from this value
-    for(int j = 0; j < vertices[i].size(); j++) {
-      const Transition &trans = vertices[i][j];
-      outfile << trans.target << endl;  // target of transition
-      outfile << trans.op << endl; // operator doing the transition
-      // calculate number of important prevail conditions
-      int number = 0;
-      for(int k = 0; k < trans.condition.size(); k++)
-	if(trans.condition[k].first->get_level() != -1)
-	  number++;
-      outfile << number << endl; 
-      for(int k = 0; k < trans.condition.size(); k++)
-	if(trans.condition[k].first->get_level() != -1)
-	  outfile << trans.condition[k].first->get_level() <<
-	    " " << trans.condition[k].second << endl; // condition: var, val
+    const Vertex &vertex = vertices[i];
+    const vector<int> &suppressed = suppressed_wildcards[i];
+    int number = vertex.size() - suppressed.size();
+    for(int j = 0; j < wildcard_transitions.size(); j++)
+      if(wildcard_transitions[j].target != i)
+	number++;
+    outfile << number << endl; // number of transitions from this value
+    int j = 0, k = 0, next_suppressed = 0;
+    while(j < vertex.size() || k < wildcard_transitions.size()) {
+      if(k < wildcard_transitions.size() &&
+	 (wildcard_transitions[k].target == i ||
+	  (next_suppressed < suppressed.size() && suppressed[next_suppressed] == k))) {
+	if(wildcard_transitions[k].target != i)
+	  next_suppressed++;
+	k++;
+      } else if(k == wildcard_transitions.size() ||
+		(j < vertex.size() && !order(wildcard_transitions[k], vertex[j]))) {
+	generate_transition(outfile, vertex[j++]);
+      } else {
+	generate_transition(outfile, wildcard_transitions[k++]);
+      }
     }
   }
 }
-
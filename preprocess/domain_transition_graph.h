@@ -23,46 +23,161 @@
 #ifndef DOMAIN_TRANSITION_GRAPH_H
 #define DOMAIN_TRANSITION_GRAPH_H
 
+#include <map>
 #include <vector>
 #include <fstream>
 using namespace std;
 
+#include "condition_pool.h"
+
 class Operator;
 class Axiom;
 class Variable;
 
+// Distances between the values of a variable in its DTG. The distance from
+// value i to value j is at [i * range + j], and -1 if j cannot be reached
+// from i.
+struct DTGDistanceTable {
+  int range;
+  vector<int> steps;    // fewest transitions
+  vector<double> cost;  // cheapest path by operator cost; axioms cost 0
+};
+
 class DomainTransitionGraph {
-public:
-  typedef vector<pair<const Variable *, int> > Condition;
-private:
   struct Transition {
-    Transition(int theTarget, int theOp) : target(theTarget), op(theOp) {}
+    Transition(int theTarget, int theOp, ConditionID theCondition)
+      : target(theTarget), op(theOp), condition(theCondition), supporters(-1) {}
     bool operator==(const Transition &other) const {return target == other.target &&
 						      op == other.op &&
 						      condition == other.condition;}
-    bool operator<(const Transition &other) const;
     int target;
     int op;
-    Condition condition;
+    ConditionID condition;
+    // Index into supporting_ops if several operators induce this
+    // transition and they are listed, -1 otherwise.
+    int supporters;
+  };
+  // Transitions by (target, condition).
+  typedef map<pair<int, ConditionID>, int> EdgeMap;
+  // Orders transitions by target and then by condition size.
+  class TransitionOrder {
+    const ConditionPool *pool;
+  public:
+    TransitionOrder(const ConditionPool *thePool) : pool(thePool) {}
+    bool operator()(const Transition &t1, const Transition &t2) const {
+      if(t1.target != t2.target)
+	return t1.target < t2.target;
+      return pool->size(t1.condition) < pool->size(t2.condition);
+    }
   };
   typedef vector<Transition> Vertex;
   vector<Vertex> vertices;
+  // Transitions for effects with pre == -1, which apply from every value
+  // other than their target. They are stored only once.
+  vector<Transition> wildcard_transitions;
+  // For each source value, the (sorted) indices of the wildcard transitions
+  // that are dominated by one of its own transitions.
+  vector<vector<int> > suppressed_wildcards;
+  vector<vector<int> > supporting_ops;  // sorted
   int level;
+  bool derived;
+  const ConditionPool *pool;
+
+  bool is_cheaper(const vector<Operator> &operators, int op1, int op2) const;
+  void merge_equal_transitions(vector<Transition> &transitions,
+			       const vector<Operator> &operators,
+			       EdgeMap &edges);
+  double get_cost(const vector<Operator> &operators,
+		  const Transition &trans) const;
+  void dump_transition(const Transition &trans) const;
+  void generate_transition(ostream &outfile, const Transition &trans) const;
 public:
-  DomainTransitionGraph(const Variable &var);
-  void addTransition(int from, int to, const Operator &op, int op_index);
-  void addAxTransition(int from, int to, const Axiom &ax, int ax_index);
+  DomainTransitionGraph(const Variable &var, const ConditionPool &pool);
+  void addTransition(int from, int to, int op_index, ConditionID condition);
+  // Merges the transitions from the same source with the same target and
+  // condition, including the wildcard transitions that would otherwise
+  // be dominated by such a transition. Must be called before finalize().
+  void merge_transitions(const vector<Operator> &operators);
   void finalize();
   void dump() const;
-  void generate_cpp_input(ofstream &outfile) const;
+  void generate_cpp_input(ostream &outfile) const;
   bool is_strongly_connected() const;
+  // Shortest paths by BFS and Dijkstra from every value, over the
+  // transitions as written (wildcards expanded, dominated ones left out).
+  void compute_distances(const vector<Operator> &operators,
+			 DTGDistanceTable &table) const;
 };
 
+// An effect that induces a transition, with the interned condition of
+// that transition.
+struct DTGEffectSource {
+  DTGEffectSource(int theOp, int theEffect, ConditionID theCondition)
+    : op(theOp), effect(theEffect), condition(theCondition) {}
+  int op;
+  int effect;
+  ConditionID condition;
+};
+
+// For each variable level, the operator effects and the axioms (with
+// their conditions) that induce transitions in its DTG, in operator order.
+struct DTGSources {
+  vector<vector<DTGEffectSource> > effects_by_var;
+  vector<vector<pair<int, ConditionID> > > axioms_by_var;
+};
+
+// If set, wildcard transitions are written in a compact section at the end
+// of each DTG instead of being expanded into every source value.
+extern bool g_compact_wildcard_transitions;
+// If set, transitions with the same source, target and condition are
+// merged into one, written with the list of operators inducing it: the
+// operator line of a transition becomes "<k> <op>..." (ascending).
+extern bool g_merge_dtg_transitions;
+// If set, the operator of such a merged transition is the cheapest one
+// (the first one among equally cheap ones) instead of the first one.
+// Without g_merge_dtg_transitions this keeps the usual format.
+extern bool g_cheapest_dtg_transitions;
+// If set, the distance tables of all DTGs are computed and written after
+// the main output.
+extern bool g_dtg_distances;
+
+extern void build_DTG_sources(const vector<Variable *> &varOrder,
+			      const vector<Operator> &operators,
+			      const vector<Axiom> &axioms,
+			      ConditionPool &conditions,
+			      DTGSources &sources);
+extern void build_DTG(const Variable &var,
+		      const vector<Operator> &operators,
+		      const vector<Axiom> &axioms,
+		      const DTGSources &sources,
+		      DomainTransitionGraph &transition_graph);
+// If distances is not null, it is resized to one table per level and the
+// tables are computed in the same jobs that build the graphs.
 extern void build_DTGs(const vector<Variable *> &varOrder,
 		       const vector<Operator> &operators,
 		       const vector<Axiom> &axioms,
-		       vector<DomainTransitionGraph> &transition_graphs);
+		       ConditionPool &conditions,
+		       vector<DomainTransitionGraph> &transition_graphs,
+		       vector<DTGDistanceTable> *distances);
 extern bool are_DTGs_strongly_connected(const vector<DomainTransitionGraph> &transition_graphs); 
+// Builds, writes and frees one DTG at a time. Returns whether all DTGs are
+// strongly connected if check_connectivity is set, false otherwise. The
+// distance tables are filled in as in build_DTGs.
+extern bool generate_DTGs_streaming(ostream &outfile,
+				    const vector<Variable *> &varOrder,
+				    const vector<Operator> &operators,
+				    const vector<Axiom> &axioms,
+				    ConditionPool &conditions,
+				    bool check_connectivity,
+				    vector<DTGDistanceTable> *distances);
+// Writes the distance tables in level order:
+//   begin_DTG_distances
+//   <number of variables>
+//   for each variable: <range>, then <range> lines with the fewest
+//   transitions from each value to every value, then <range> lines with
+//   the cheapest costs; -1 marks an unreachable value
+//   end_DTG_distances
+extern void generate_DTG_distances(ostream &outfile,
+				   const vector<DTGDistanceTable> &distances);
 //extern vector<DomainTransitionGraph> &transition_graphs;
 
 #endif
@@ -0,0 +1,33 @@
+/*********************************************************************
+ * This file is part of LAMA.
+ *
+ * LAMA is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the license, or (at your option) any later version.
+ *
+ * LAMA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ *********************************************************************/
+
+#include "fact_index.h"
+
+FactIndex::FactIndex(const vector<Variable *> &variables) {
+  offsets.resize(variables.size());
+  num_facts = 0;
+  for(int i = 0; i < variables.size(); i++) {
+    assert(variables[i]->get_index() == i);
+    offsets[i] = num_facts;
+    num_facts += variables[i]->get_range();
+  }
+  variable_of_fact.reserve(num_facts);
+  for(int i = 0; i < variables.size(); i++)
+    variable_of_fact.insert(variable_of_fact.end(), variables[i]->get_range(),
+			    variables[i]);
+}
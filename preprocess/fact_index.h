@@ -0,0 +1,60 @@
+/*********************************************************************
+ * This file is part of LAMA.
+ *
+ * LAMA is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the license, or (at your option) any later version.
+ *
+ * LAMA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ *********************************************************************/
+
+#ifndef FACT_INDEX_H
+#define FACT_INDEX_H
+
+/*
+  Dense numbering of all (variable, value) pairs of the task.
+
+  The facts of a variable are numbered consecutively and variables are
+  laid out in input order, so sorting fact IDs gives the same order as
+  sorting (Variable *, value) pairs, and a fact can be mapped back to its
+  variable and value.
+*/
+
+#include "variable.h"
+
+#include <cassert>
+#include <vector>
+using namespace std;
+
+class FactIndex {
+  vector<int> offsets; // indexed by variable index
+  vector<const Variable *> variable_of_fact;
+  int num_facts;
+public:
+  FactIndex(const vector<Variable *> &variables);
+  int get_fact(const Variable *var, int value) const {
+    assert(value >= 0 && value < var->get_range());
+    return offsets[var->get_index()] + value;
+  }
+  // First fact of the variable; its facts are [first, first + range).
+  int get_first_fact(const Variable *var) const {
+    return offsets[var->get_index()];
+  }
+  const Variable *get_variable(int fact) const {
+    return variable_of_fact[fact];
+  }
+  int get_value(int fact) const {
+    return fact - offsets[variable_of_fact[fact]->get_index()];
+  }
+  int get_num_facts() const {return num_facts;}
+};
+
+#endif
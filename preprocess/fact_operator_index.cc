@@ -0,0 +1,111 @@
+/*********************************************************************
+ * This file is part of LAMA.
+ *
+ * LAMA is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the license, or (at your option) any later version.
+ *
+ * LAMA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ *********************************************************************/
+
+#include "fact_operator_index.h"
+#include "operator.h"
+#include "variable.h"
+
+#include <algorithm>
+#include <iostream>
+using namespace std;
+
+bool g_fact_operator_index = false;
+
+// Operators by fact in compressed rows: the operators of fact f are
+// [begin[f], begin[f + 1]) in ops.
+struct FactOperatorRows {
+  vector<int> begin;
+  vector<int> ops;
+};
+
+// Fills the rows from (fact, operator) pairs given in operator order.
+static void build_rows(int num_facts, const vector<pair<int, int> > &entries,
+		       FactOperatorRows &rows) {
+  rows.begin.assign(num_facts + 1, 0);
+  for(int i = 0; i < entries.size(); i++)
+    rows.begin[entries[i].first + 1]++;
+  for(int fact = 0; fact < num_facts; fact++)
+    rows.begin[fact + 1] += rows.begin[fact];
+  rows.ops.resize(entries.size());
+  vector<int> next(rows.begin.begin(), rows.begin.end() - 1);
+  for(int i = 0; i < entries.size(); i++)
+    rows.ops[next[entries[i].first]++] = entries[i].second;
+}
+
+static void write_rows(ostream &outfile, int num_facts,
+		       const FactOperatorRows &rows) {
+  for(int fact = 0; fact < num_facts; fact++) {
+    outfile << rows.begin[fact + 1] - rows.begin[fact];
+    for(int i = rows.begin[fact]; i < rows.begin[fact + 1]; i++)
+      outfile << " " << rows.ops[i];
+    outfile << endl;
+  }
+}
+
+void generate_fact_operator_index(ostream &outfile,
+				  const vector<Operator> &operators,
+				  const vector<Variable *> &variables) {
+  int num_levels = 0;
+  for(int i = 0; i < variables.size(); i++)
+    num_levels = max(num_levels, variables[i]->get_level() + 1);
+  vector<int> range_of_level(num_levels, 0);
+  for(int i = 0; i < variables.size(); i++)
+    if(variables[i]->get_level() != -1)
+      range_of_level[variables[i]->get_level()] = variables[i]->get_range();
+  vector<int> first_fact(num_levels + 1, 0);
+  for(int level = 0; level < num_levels; level++)
+    first_fact[level + 1] = first_fact[level] + range_of_level[level];
+  int num_facts = first_fact[num_levels];
+
+  vector<pair<int, int> > preconditions, achievers;
+  for(int i = 0; i < operators.size(); i++) {
+    const Operator &op = operators[i];
+    for(int j = 0; j < op.get_prevail().size(); j++) {
+      Operator::Prevail prev = op.get_prevail()[j];
+      preconditions.push_back(
+	make_pair(first_fact[prev.var->get_level()] + prev.prev, i));
+    }
+    Operator::PrePostRange effects = op.get_propositional_effects();
+    int first_achiever = achievers.size();
+    for(int j = 0; j < effects.size(); j++) {
+      Operator::PrePost eff = effects[j];
+      int first = first_fact[eff.var->get_level()];
+      if(eff.pre != PRE_ANY)
+	preconditions.push_back(make_pair(first + eff.pre, i));
+      // Conditional effects may achieve the same value more than once.
+      pair<int, int> achiever(first + eff.post, i);
+      bool seen = false;
+      for(int k = first_achiever; k < achievers.size(); k++)
+	seen = seen || achievers[k] == achiever;
+      if(!seen)
+	achievers.push_back(achiever);
+    }
+  }
+
+  FactOperatorRows precondition_of, achiever_of;
+  build_rows(num_facts, preconditions, precondition_of);
+  build_rows(num_facts, achievers, achiever_of);
+
+  outfile << "begin_fact_operators" << endl;
+  outfile << num_facts << endl;
+  write_rows(outfile, num_facts, precondition_of);
+  write_rows(outfile, num_facts, achiever_of);
+  outfile << "end_fact_operators" << endl;
+  cout << "Indexed " << preconditions.size() << " preconditions and "
+       << achievers.size() << " achievers of " << num_facts << " facts." << endl;
+}
@@ -0,0 +1,57 @@
+/*********************************************************************
+ * This file is part of LAMA.
+ *
+ * LAMA is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the license, or (at your option) any later version.
+ *
+ * LAMA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ *********************************************************************/
+
+#ifndef FACT_OPERATOR_INDEX_H
+#define FACT_OPERATOR_INDEX_H
+
+/*
+  Inverted indices from facts to operators, so that the search does not
+  have to rebuild them from the operator list.
+
+  Facts are numbered by level: the facts of the variable at level l are
+  [first(l), first(l) + range(l)), where first(0) = 0 and the variables
+  follow each other in level order. For every fact the index lists the
+  operators that have it as a precondition (prevail condition or effect
+  precondition) and the operators that achieve it (propositional effects,
+  conditional or not), each in increasing operator order. Effect
+  conditions, numeric and blocking effects are not indexed. The section
+  written after the main output is
+
+    begin_fact_operators
+    <number of facts>
+    <k> <operator>...       (preconditions, one line per fact)
+    ...
+    <k> <operator>...       (achievers, one line per fact)
+    ...
+    end_fact_operators
+*/
+
+#include <fstream>
+#include <vector>
+using namespace std;
+
+class Operator;
+class Variable;
+
+extern bool g_fact_operator_index;
+
+extern void generate_fact_operator_index(ostream &outfile,
+					 const vector<Operator> &operators,
+					 const vector<Variable *> &variables);
+
+#endif
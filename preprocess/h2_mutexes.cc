@@ -0,0 +1,276 @@
+/*********************************************************************
+ * This file is part of LAMA.
+ *
+ * LAMA is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the license, or (at your option) any later version.
+ *
+ * LAMA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ *********************************************************************/
+
+#include "h2_mutexes.h"
+#include "fact_index.h"
+#include "operator.h"
+#include "state.h"
+#include "variable.h"
+
+#include <algorithm>
+#include <ctime>
+#include <iostream>
+using namespace std;
+
+bool g_h2_mutexes = false;
+double g_h2_time_limit = 60;
+
+struct H2Operator {
+  vector<int> pre;
+  vector<int> adds;       // also pairwise reachable with each other
+  int num_certain_adds;   // adds[0 .. num_certain_adds) always happen
+  vector<const Variable *> changed_vars;
+};
+
+static bool has_lower_level(const Variable *v1, const Variable *v2) {
+  return v1->get_level() < v2->get_level();
+}
+
+H2Mutexes::H2Mutexes(const FactIndex &fact_index)
+  : facts(fact_index), words(0), complete(false) {
+}
+
+void H2Mutexes::get_preconditions(const Operator &op, vector<int> &pre) const {
+  pre.clear();
+  for(int i = 0; i < op.get_prevail().size(); i++) {
+    Operator::Prevail prev = op.get_prevail()[i];
+    if(analysed[prev.var->get_index()])
+      pre.push_back(facts.get_fact(prev.var, prev.prev));
+  }
+  Operator::PrePostRange effects = op.get_propositional_effects();
+  for(int i = 0; i < effects.size(); i++) {
+    Operator::PrePost eff = effects[i];
+    if(eff.pre != PRE_ANY && analysed[eff.var->get_index()])
+      pre.push_back(facts.get_fact(eff.var, eff.pre));
+  }
+  sort(pre.begin(), pre.end());
+  pre.erase(unique(pre.begin(), pre.end()), pre.end());
+}
+
+bool H2Mutexes::are_reachable(const vector<int> &pre) const {
+  for(int i = 0; i < pre.size(); i++)
+    for(int j = i; j < pre.size(); j++)
+      if(!is_reachable(pre[i], pre[j]))
+	return false;
+  return true;
+}
+
+void H2Mutexes::clear_facts(vector<Word> &bits, int first, int last) {
+  for(int fact = first; fact < last; fact++)
+    bits[fact / BITS] &= ~(Word(1) << (fact % BITS));
+}
+
+bool H2Mutexes::compute(const vector<Variable *> &variables,
+			const vector<Operator> &operators,
+			const State &initial_state,
+			const vector<Variable *> &shared_vars,
+			const vector<pair<pair<Variable*, int>, vector<pair<pair<Variable*, int>, double> > > > &timed_goals,
+			double time_limit) {
+  clock_t start = clock();
+  analysed.assign(variables.size(), true);
+  for(int i = 0; i < variables.size(); i++) {
+    Variable *var = variables[i];
+    if(var->is_derived() || var->get_level() == -1 || initial_state[var] == -1)
+      analysed[i] = false;
+  }
+  for(int i = 0; i < shared_vars.size(); i++)
+    analysed[shared_vars[i]->get_index()] = false;
+  for(int i = 0; i < timed_goals.size(); i++)
+    for(int j = 0; j < timed_goals[i].second.size(); j++)
+      analysed[timed_goals[i].second[j].first.first->get_index()] = false;
+  for(int i = 0; i < operators.size(); i++) {
+    Operator::PrePostRange numeric = operators[i].get_numeric_effects();
+    for(int j = 0; j < numeric.size(); j++)
+      analysed[numeric[j].var->get_index()] = false;
+  }
+
+  vector<H2Operator> ops(operators.size());
+  for(int i = 0; i < operators.size(); i++) {
+    const Operator &op = operators[i];
+    H2Operator &h2_op = ops[i];
+    get_preconditions(op, h2_op.pre);
+    vector<int> maybe_adds;
+    Operator::PrePostRange ranges[2] = {op.get_propositional_effects(),
+					op.get_pre_block()};
+    for(int r = 0; r < 2; r++) {
+      for(int j = 0; j < ranges[r].size(); j++) {
+	Operator::PrePost eff = ranges[r][j];
+	if(!analysed[eff.var->get_index()] ||
+	   eff.post < 0 || eff.post >= eff.var->get_range())
+	  continue;
+	int fact = facts.get_fact(eff.var, eff.post);
+	if(r == 0 && !eff.is_conditional_effect) {
+	  h2_op.adds.push_back(fact);
+	  h2_op.changed_vars.push_back(eff.var);
+	} else {
+	  maybe_adds.push_back(fact);
+	}
+      }
+    }
+    h2_op.num_certain_adds = h2_op.adds.size();
+    h2_op.adds.insert(h2_op.adds.end(), maybe_adds.begin(), maybe_adds.end());
+  }
+
+  int num_facts = facts.get_num_facts();
+  words = (num_facts + BITS - 1) / BITS;
+  reachable_pairs.assign(num_facts * words, 0);
+  vector<Word> reached(words, 0);
+
+  vector<int> initial_facts;
+  for(int i = 0; i < variables.size(); i++)
+    if(analysed[i] && initial_state[variables[i]] < variables[i]->get_range())
+      initial_facts.push_back(facts.get_fact(variables[i], initial_state[variables[i]]));
+  for(int i = 0; i < initial_facts.size(); i++) {
+    reached[initial_facts[i] / BITS] |= Word(1) << (initial_facts[i] % BITS);
+    for(int j = i; j < initial_facts.size(); j++)
+      set_reachable(initial_facts[i], initial_facts[j]);
+  }
+
+  vector<Word> together(words), new_pairs(words);
+  bool changed = true;
+  while(changed) {
+    changed = false;
+    for(int i = 0; i < ops.size(); i++) {
+      if(i % 64 == 0 &&
+	 double(clock() - start) / CLOCKS_PER_SEC > time_limit) {
+	cout << "h^2 mutex analysis ran out of time, results discarded." << endl;
+	reachable_pairs.clear();
+	return false;
+      }
+      const H2Operator &op = ops[i];
+      if(op.adds.empty() || !are_reachable(op.pre))
+	continue;
+
+      // Facts reachable together with all preconditions that the
+      // operator leaves alone.
+      if(op.pre.empty())
+	together = reached;
+      else
+	together.assign(row(op.pre[0]), row(op.pre[0]) + words);
+      for(int j = 1; j < op.pre.size(); j++) {
+	const Word *pre_row = row(op.pre[j]);
+	for(int w = 0; w < words; w++)
+	  together[w] &= pre_row[w];
+      }
+      for(int j = 0; j < op.changed_vars.size(); j++) {
+	int first = facts.get_first_fact(op.changed_vars[j]);
+	clear_facts(together, first, first + op.changed_vars[j]->get_range());
+      }
+
+      for(int j = 0; j < op.adds.size(); j++) {
+	int fact = op.adds[j];
+	if(!is_reachable(fact, fact)) {
+	  reached[fact / BITS] |= Word(1) << (fact % BITS);
+	  set_reachable(fact, fact);
+	  changed = true;
+	}
+	new_pairs = together;
+	if(j >= op.num_certain_adds) {
+	  const Variable *var = facts.get_variable(fact);
+	  int first = facts.get_first_fact(var);
+	  clear_facts(new_pairs, first, first + var->get_range());
+	}
+	Word *fact_row = row(fact);
+	for(int w = 0; w < words; w++) {
+	  Word bits = new_pairs[w] & ~fact_row[w];
+	  if(!bits)
+	    continue;
+	  changed = true;
+	  fact_row[w] |= bits;
+	  for(int b = 0; bits; b++, bits >>= 1)
+	    if(bits & 1)
+	      row(w * BITS + b)[fact / BITS] |= Word(1) << (fact % BITS);
+	}
+	for(int k = 0; k < j; k++) {
+	  int other = op.adds[k];
+	  if(facts.get_variable(other) != facts.get_variable(fact) &&
+	     !is_reachable(fact, other)) {
+	    set_reachable(fact, other);
+	    changed = true;
+	  }
+	}
+      }
+    }
+  }
+  complete = true;
+  return true;
+}
+
+void H2Mutexes::prune_operators(vector<Operator> &operators) const {
+  int old_count = operators.size();
+  int new_index = 0;
+  vector<int> pre;
+  for(int i = 0; i < operators.size(); i++) {
+    get_preconditions(operators[i], pre);
+    if(are_reachable(pre))
+      operators[new_index++] = operators[i];
+  }
+  operators.erase(operators.begin() + new_index, operators.end());
+  cout << operators.size() << " of " << old_count
+       << " operators left after removing operators with mutex preconditions."
+       << endl;
+}
+
+void H2Mutexes::generate_cpp_input(ostream &outfile,
+				   const vector<Variable *> &variables) const {
+  vector<Variable *> ordered_vars;
+  for(int i = 0; i < variables.size(); i++)
+    if(analysed[i])
+      ordered_vars.push_back(variables[i]);
+  sort(ordered_vars.begin(), ordered_vars.end(), has_lower_level);
+  vector<int> ordered_facts;
+  for(int i = 0; i < ordered_vars.size(); i++)
+    for(int value = 0; value < ordered_vars[i]->get_range(); value++)
+      ordered_facts.push_back(facts.get_fact(ordered_vars[i], value));
+
+  outfile << "begin_mutexes" << endl;
+  vector<int> unreachable;
+  for(int i = 0; i < ordered_facts.size(); i++)
+    if(!is_reachable(ordered_facts[i], ordered_facts[i]))
+      unreachable.push_back(ordered_facts[i]);
+  outfile << unreachable.size() << endl;
+  for(int i = 0; i < unreachable.size(); i++)
+    outfile << facts.get_variable(unreachable[i])->get_level() << " "
+	    << facts.get_value(unreachable[i]) << endl;
+
+  vector<pair<int, vector<int> > > groups;
+  for(int i = 0; i < ordered_facts.size(); i++) {
+    int fact = ordered_facts[i];
+    if(!is_reachable(fact, fact))
+      continue;
+    vector<int> mutex;
+    for(int j = i + 1; j < ordered_facts.size(); j++) {
+      int other = ordered_facts[j];
+      if(facts.get_variable(other) != facts.get_variable(fact) &&
+	 is_reachable(other, other) && !is_reachable(fact, other))
+	mutex.push_back(other);
+    }
+    if(!mutex.empty())
+      groups.push_back(make_pair(fact, mutex));
+  }
+  outfile << groups.size() << endl;
+  for(int i = 0; i < groups.size(); i++) {
+    outfile << facts.get_variable(groups[i].first)->get_level() << " "
+	    << facts.get_value(groups[i].first) << " " << groups[i].second.size();
+    for(int j = 0; j < groups[i].second.size(); j++)
+      outfile << " " << facts.get_variable(groups[i].second[j])->get_level()
+	      << " " << facts.get_value(groups[i].second[j]);
+    outfile << endl;
+  }
+  outfile << "end_mutexes" << endl;
+}
@@ -0,0 +1,109 @@
+/*********************************************************************
+ * This file is part of LAMA.
+ *
+ * LAMA is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the license, or (at your option) any later version.
+ *
+ * LAMA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ *********************************************************************/
+
+#ifndef H2_MUTEXES_H
+#define H2_MUTEXES_H
+
+/*
+  h^2 mutexes: pairs of facts that can never be true together.
+
+  The analysis computes the facts and fact pairs reachable from the
+  initial state in the h^2 relaxation. An operator is applicable if its
+  preconditions (prevail conditions and effect preconditions) are reachable
+  pairwise. It then reaches its effects together, and each effect together
+  with every fact that is reachable with all its preconditions and not on
+  a variable it changes. Reachable pairs are kept in a bit matrix over the
+  fact IDs of a FactIndex, so the facts reachable together with all
+  preconditions of an operator are the AND of their rows.
+
+  Only finite-domain state variables this agent alone controls are
+  analysed. Numeric and derived variables, shared variables and variables
+  of timed facts are left out. Their conditions are ignored and their
+  values are not tracked, which only makes more pairs reachable.
+  Conditional and blocking effects are treated as effects that may or may
+  not happen, so they add their value but delete nothing. Axioms only
+  change derived variables and are ignored.
+
+  If the analysis takes longer than the time limit, it is given up and
+  nothing is pruned or written. Otherwise operators whose preconditions
+  are not reachable are removed, and the mutexes between variables of the
+  output are written after the main output:
+
+    begin_mutexes
+    <number of unreachable facts>
+    <level> <value>
+    ...
+    <number of groups>
+    <level> <value> <k> <level> <value> ...   (k facts mutex with the first,
+    ...                                         all later in (level, value) order)
+    end_mutexes
+
+  Values of the same variable are always mutex and are not listed.
+*/
+
+#include <fstream>
+#include <vector>
+using namespace std;
+
+class FactIndex;
+class Operator;
+class State;
+class Variable;
+
+extern bool g_h2_mutexes;
+extern double g_h2_time_limit; // seconds of CPU time
+
+class H2Mutexes {
+  typedef unsigned long Word;
+  static const int BITS = sizeof(Word) * 8;
+
+  const FactIndex &facts;
+  vector<bool> analysed;         // by variable index
+  int words;                     // words per row
+  vector<Word> reachable_pairs;  // row of fact p at p * words
+  bool complete;
+
+  Word *row(int fact) {return &reachable_pairs[fact * words];}
+  const Word *row(int fact) const {return &reachable_pairs[fact * words];}
+  bool is_reachable(int fact1, int fact2) const {
+    return (row(fact1)[fact2 / BITS] >> (fact2 % BITS)) & 1;
+  }
+  void set_reachable(int fact1, int fact2) {
+    row(fact1)[fact2 / BITS] |= Word(1) << (fact2 % BITS);
+    row(fact2)[fact1 / BITS] |= Word(1) << (fact1 % BITS);
+  }
+  static void clear_facts(vector<Word> &bits, int first, int last);
+  void get_preconditions(const Operator &op, vector<int> &pre) const;
+  bool are_reachable(const vector<int> &pre) const;
+public:
+  H2Mutexes(const FactIndex &facts);
+  // Returns false if the time limit was reached; then there are no results.
+  bool compute(const vector<Variable *> &variables,
+	       const vector<Operator> &operators,
+	       const State &initial_state,
+	       const vector<Variable *> &shared_vars,
+	       const vector<pair<pair<Variable*, int>, vector<pair<pair<Variable*, int>, double> > > > &timed_goals,
+	       double time_limit);
+  bool is_complete() const {return complete;}
+  // Removes the operators whose preconditions are mutex or unreachable.
+  void prune_operators(vector<Operator> &operators) const;
+  void generate_cpp_input(ostream &outfile,
+			  const vector<Variable *> &variables) const;
+};
+
+#endif
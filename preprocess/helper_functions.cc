@@ -31,6 +31,16 @@ using namespace std;
 #include "helper_functions.h"
 #include "state.h"
 #include "operator.h"
+#include "cost_bytecode.h"
+#include "module_index.h"
+#include "timed_goals.h"
+#include "h2_mutexes.h"
+#include "numeric_bounds.h"
+#include "fact_operator_index.h"
+#include "landmarks.h"
+#include "axiom_layers.h"
+#include "state_packing.h"
+#include "precondition_matrix.h"
 #include "axiom.h"
 #include "variable.h"
 #include "successor_generator.h"
@@ -70,7 +80,7 @@ void read_variables(istream &in, vector<Variable> &internal_variables,
   internal_variables.reserve(count);
   // Important so that the iterators stored in variables are valid.
   for(int i = 0; i < count; i++) {
-    internal_variables.push_back(Variable(in));
+    internal_variables.push_back(Variable(in, i));
     variables.push_back(&internal_variables.back());
   }
   check_magic(in, "end_variables");
@@ -162,11 +172,12 @@ void dump_goal(const vector<pair<Variable*, int> > &goals) {
 }
 
 void read_operators(istream &in, const vector<Variable *> &variables, 
-		    vector<Operator> &operators) {
+		    vector<Operator> &operators, OperatorArena &operator_arena) {
   int count;
   in >> count;
+  operators.reserve(count);
   for(int i = 0; i < count; i++)
-    operators.push_back(Operator(in, variables));
+    operators.push_back(Operator(in, variables, operator_arena, i));
 }
 void read_axioms(istream &in, const vector<Variable *> &variables, 
 		    vector<Axiom> &axioms) {
@@ -185,6 +196,7 @@ void read_preprocessed_problem_description(istream &in,
 					   vector<pair<Variable*, int> > &goals,
 					   vector<pair<pair<Variable*, int>, vector<pair<pair<Variable*, int>, double > > > > &timed_goals,
 					   vector<Operator> &operators,
+					   OperatorArena &operator_arena,
 					   vector<Axiom> &axioms,
 					   vector<Variable *> &shared_vars,
 					   vector<int> &shared_vars_number,
@@ -196,7 +208,7 @@ void read_preprocessed_problem_description(istream &in,
   read_goal(in, variables, goals);
   read_timed_goal(in, variables, timed_goals);
   read_modules(in, modules);
-  read_operators(in, variables, operators);
+  read_operators(in, variables, operators, operator_arena);
   read_axioms(in, variables, axioms);
 }
 
@@ -237,6 +249,54 @@ std::string ReplaceAll(std::string str, const std::string& from, const std::stri
     return str;
 }
 
+string get_output_file_name(const string &name, const string &prefix) {
+  string f_name = "output_prepro";
+  f_name = f_name + name;
+  if(prefix != "")
+	  f_name = prefix + "_" + f_name;
+  return f_name;
+}
+
+void generate_optional_sections(const string &file_name,
+				const vector<Variable *> &variables,
+				const vector<Operator> &operators,
+				const H2Mutexes &mutexes,
+				const NumericBounds &numeric_bounds,
+				const LandmarkGraph &landmarks,
+				const AxiomLayers &axiom_layers,
+				const StatePacking &state_packing,
+				const PreconditionMatrix &precondition_matrix,
+				const vector<DTGDistanceTable> &dtg_distances) {
+  if(!g_cost_bytecode && !mutexes.is_complete() &&
+     !numeric_bounds.is_computed() && !landmarks.is_computed() &&
+     !axiom_layers.is_checked() && !state_packing.is_computed() &&
+     !precondition_matrix.is_computed() &&
+     !g_fact_operator_index && !g_dtg_distances && !g_renumber_operators)
+    return;
+  ofstream outfile(file_name.c_str(), ios::out | ios::app);
+  if(g_cost_bytecode)
+    generate_cost_bytecode(outfile, operators, variables);
+  if(mutexes.is_complete())
+    mutexes.generate_cpp_input(outfile, variables);
+  if(numeric_bounds.is_computed())
+    numeric_bounds.generate_cpp_input(outfile);
+  if(landmarks.is_computed())
+    landmarks.generate_cpp_input(outfile);
+  if(axiom_layers.is_checked())
+    axiom_layers.generate_cpp_input(outfile);
+  if(state_packing.is_computed())
+    state_packing.generate_cpp_input(outfile);
+  if(precondition_matrix.is_computed())
+    precondition_matrix.generate_cpp_input(outfile);
+  if(g_fact_operator_index)
+    generate_fact_operator_index(outfile, operators, variables);
+  if(g_dtg_distances)
+    generate_DTG_distances(outfile, dtg_distances);
+  if(g_renumber_operators)
+    generate_operator_permutation(outfile, operators);
+  outfile.close();
+}
+
 void generate_cpp_input(bool solveable_in_poly_time,
 			const vector<Variable *> & ordered_vars, 
 			const string &metric,
@@ -244,10 +304,11 @@ void generate_cpp_input(bool solveable_in_poly_time,
 			const vector<pair<Variable*, int> > &goals,
 			const vector<pair<pair<Variable*, int>, vector<pair<pair<Variable*, int>, double> > > > &timed_goals,
 			const vector<pair<string, vector<pair<string, vector<pair<string, string> > > > > > modules,
+			const ModuleIndex &module_index,
 			const vector<Operator> & operators,
 			const vector<Axiom> &axioms,
 			const SuccessorGenerator &sg,
-			const vector<DomainTransitionGraph> transition_graphs,
+			const vector<DomainTransitionGraph> &transition_graphs,
 			const CausalGraph &cg,
 			string name,
 			vector<Variable *> &shared_vars,
@@ -255,12 +316,36 @@ void generate_cpp_input(bool solveable_in_poly_time,
 			vector<Variable *> variables,
 			string prefix) {
   ofstream outfile;
+  outfile.open(get_output_file_name(name, prefix).c_str(), ios::out);
+  generate_cpp_input_prefix(outfile, solveable_in_poly_time, ordered_vars, metric,
+			    initial_state, goals, timed_goals, modules,
+			    module_index, operators,
+			    axioms, name, shared_vars, shared_vars_number, variables);
+  generate_cpp_input_suffix(outfile, ordered_vars, sg, transition_graphs, cg);
+  outfile.close();
+}
+
+/* The prefix covers everything up to and including the axioms. It only
+ * depends on the variable ordering and the stripped operators and axioms,
+ * so it can be written while the DTGs and the successor generator are
+ * still being built (see OutputPipeline).
+ */
+void generate_cpp_input_prefix(ostream &outfile,
+			bool solveable_in_poly_time,
+			const vector<Variable *> & ordered_vars,
+			const string &metric,
+			const State &initial_state,
+			const vector<pair<Variable*, int> > &goals,
+			const vector<pair<pair<Variable*, int>, vector<pair<pair<Variable*, int>, double> > > > &timed_goals,
+			const vector<pair<string, vector<pair<string, vector<pair<string, string> > > > > > &modules,
+			const ModuleIndex &module_index,
+			const vector<Operator> & operators,
+			const vector<Axiom> &axioms,
+			const string &name,
+			const vector<Variable *> &shared_vars,
+			const vector<int> &shared_vars_number,
+			const vector<Variable *> &variables) {
   string metric_str;
-  string f_name = "output_prepro";
-  f_name = f_name + name;
-  if(prefix != "")
-	  f_name = prefix + "_" + f_name;
-  outfile.open(f_name.c_str(),ios::out);
   if(name == "")
 	  outfile << "gen" << endl;
   else
@@ -321,39 +406,10 @@ void generate_cpp_input(bool solveable_in_poly_time,
       outfile << i << " " << ordered_goal_values[i] << endl;
   outfile << "end_goal" << endl;
 
-  outfile << "begin_timed_goals" << endl;
-  outfile << timed_goals.size() << endl;
-  for(int i = 0; i < timed_goals.size(); i++){
-
-	  for(int j = 0; j < var_count; j++){
-		  if(ordered_goal_values[j] != -1 &&
-				  j == timed_goals[i].first.first->get_level())
-			  outfile << j << " " << ordered_goal_values[j] << endl;
-	  }
-
-	  outfile << timed_goals[i].second.size() << endl;
-
-	  vector<int> ordered_timed_facts;
-	  ordered_timed_facts.resize(var_count, -4);
-	  vector<double> ordered_timed_facts_time;
-	  ordered_timed_facts_time.resize(var_count, -1);
-
-	  for(int j = 0; j < timed_goals[i].second.size(); j++) {
-	      int var_index = timed_goals[i].second[j].first.first->get_level();
-	      string name = timed_goals[i].second[j].first.first->get_name();
-	      ordered_timed_facts[var_index] = timed_goals[i].second[j].first.second;
-	      ordered_timed_facts_time[var_index] = timed_goals[i].second[j].second;
-
-	      outfile << var_index << " " << timed_goals[i].second[j].first.second <<
-	     		  " " << timed_goals[i].second[j].second << endl;
-	  }
-
-	  /* for(int z = 0; z < var_count; z++) {
-		  if(ordered_timed_facts[z] != -4)
-			  outfile << z << " " << ordered_timed_facts[z] << " " << ordered_timed_facts_time[z] << endl;
-	  }*/
-  }
-  outfile << "end_timed_goals" << endl;
+  TimedGoalTable timed_goal_table(timed_goals, var_count);
+  timed_goal_table.generate_cpp_input(outfile, ordered_goal_values);
+  if(g_timed_goal_index)
+    timed_goal_table.generate_deadline_index(outfile);
 
   outfile << "begin_modules" << endl;
   outfile << modules.size() << endl;
@@ -369,6 +425,8 @@ void generate_cpp_input(bool solveable_in_poly_time,
 	  }
   }
   outfile << "end_modules" << endl;
+  if(module_index.is_resolved())
+    module_index.generate_cpp_input(outfile, variables);
 
   outfile << operators.size() << endl;
   for(int i = 0; i < operators.size(); i++)
@@ -377,7 +435,14 @@ void generate_cpp_input(bool solveable_in_poly_time,
   outfile << axioms.size() << endl;
   for(int i = 0; i < axioms.size(); i++)
     axioms[i].generate_cpp_input(outfile);
+}
 
+void generate_cpp_input_suffix(ostream &outfile,
+			const vector<Variable *> & ordered_vars,
+			const SuccessorGenerator &sg,
+			const vector<DomainTransitionGraph> &transition_graphs,
+			const CausalGraph &cg) {
+  int var_count = ordered_vars.size();
   outfile << "begin_SG" << endl;
   sg.generate_cpp_input(outfile);
   outfile << "end_SG" << endl;
@@ -391,7 +456,5 @@ void generate_cpp_input(bool solveable_in_poly_time,
   outfile << "begin_CG" << endl;
   cg.generate_cpp_input(outfile, ordered_vars);
   outfile << "end_CG" << endl;
-
-  outfile.close();
 }
 
@@ -32,13 +32,23 @@
 #include <string>
 #include <vector>
 #include <iostream>
+#include <fstream>
 
 using namespace std;
 
 class State;
 class Operator;
+class ModuleIndex;
+class H2Mutexes;
+class NumericBounds;
+class LandmarkGraph;
+class AxiomLayers;
+class StatePacking;
+class PreconditionMatrix;
+struct OperatorArena;
 class Axiom;
 class DomainTransitionGraph;
+struct DTGDistanceTable;
 
 std::string ReplaceAll(std::string str, const std::string& from, const std::string& to);
 
@@ -51,6 +61,7 @@ void read_preprocessed_problem_description(istream &in,
 					   vector<pair<Variable*, int> > &goals,
 					   vector<pair<pair<Variable*, int>, vector<pair<pair<Variable*, int>, double> > > > &timed_goals,
 					   vector<Operator> &operators,
+					   OperatorArena &operator_arena,
 					   vector<Axiom> &axioms,
 					   vector<Variable *> &shared_vars,
 					   vector<int> &shared_vars_number,
@@ -72,16 +83,49 @@ void generate_cpp_input(bool causal_graph_acyclic,
 			const vector<pair<Variable*, int> > &goals,
 			const vector<pair<pair<Variable*, int>, vector<pair<pair<Variable*, int>, double> > > > &timed_goals,
 			const vector<pair<string, vector<pair<string, vector<pair<string, string> > > > > > modules,
+			const ModuleIndex &module_index,
 			const vector<Operator> & operators,
 			const vector<Axiom> &axioms,
 			const SuccessorGenerator &sg,
-			const vector<DomainTransitionGraph> transition_graphs,
+			const vector<DomainTransitionGraph> &transition_graphs,
 			const CausalGraph &cg,
 			string name,
 			vector<Variable *> &shared_vars,
 			vector<int> &shared_vars_number,
 			vector<Variable *> variables,
 			string prefix);
+void generate_cpp_input_prefix(ostream &outfile,
+			bool solveable_in_poly_time,
+			const vector<Variable *> & ordered_vars,
+			const string &metric,
+			const State &initial_state,
+			const vector<pair<Variable*, int> > &goals,
+			const vector<pair<pair<Variable*, int>, vector<pair<pair<Variable*, int>, double> > > > &timed_goals,
+			const vector<pair<string, vector<pair<string, vector<pair<string, string> > > > > > &modules,
+			const ModuleIndex &module_index,
+			const vector<Operator> & operators,
+			const vector<Axiom> &axioms,
+			const string &name,
+			const vector<Variable *> &shared_vars,
+			const vector<int> &shared_vars_number,
+			const vector<Variable *> &variables);
+void generate_cpp_input_suffix(ostream &outfile,
+			const vector<Variable *> & ordered_vars,
+			const SuccessorGenerator &sg,
+			const vector<DomainTransitionGraph> &transition_graphs,
+			const CausalGraph &cg);
+string get_output_file_name(const string &name, const string &prefix);
+// Appends the sections enabled by options to the finished output file.
+void generate_optional_sections(const string &file_name,
+				const vector<Variable *> &variables,
+				const vector<Operator> &operators,
+				const H2Mutexes &mutexes,
+				const NumericBounds &numeric_bounds,
+				const LandmarkGraph &landmarks,
+				const AxiomLayers &axiom_layers,
+				const StatePacking &state_packing,
+				const PreconditionMatrix &precondition_matrix,
+				const vector<DTGDistanceTable> &dtg_distances);
 void check_magic(istream &in, string magic);
 
 #endif
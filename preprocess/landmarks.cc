@@ -0,0 +1,353 @@
+/*********************************************************************
+ * This file is part of LAMA.
+ *
+ * LAMA is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the license, or (at your option) any later version.
+ *
+ * LAMA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ *********************************************************************/
+
+#include "landmarks.h"
+#include "fact_index.h"
+#include "operator.h"
+#include "parallel.h"
+#include "state.h"
+#include "variable.h"
+
+#include <algorithm>
+#include <iterator>
+#include <iostream>
+using namespace std;
+
+bool g_landmarks = false;
+
+struct RelaxedOperator {
+  vector<int> pre;   // sorted
+  vector<int> adds;
+};
+
+// A transition of an operator in the DTG of a variable; source -1 stands
+// for any value.
+struct LandmarkArc {
+  int op, source, target;
+  LandmarkArc(int o, int s, int t) : op(o), source(s), target(t) {}
+};
+
+struct LandmarkTask {
+  const FactIndex *facts;
+  vector<RelaxedOperator> ops;
+  vector<vector<int> > achievers;        // by fact, sorted
+  vector<vector<int> > ops_with_pre;     // by fact
+  vector<vector<LandmarkArc> > arcs;     // by variable index
+  vector<int> initial_facts;
+  vector<int> initial_value;             // by variable index
+};
+
+// The facts that can be reached without achieving the excluded fact, and
+// the operators whose preconditions are among them.
+static void explore_without(const LandmarkTask &task, int excluded,
+			    vector<char> &reached, vector<char> &usable) {
+  const vector<int> &excluded_achievers = task.achievers[excluded];
+  reached.assign(task.facts->get_num_facts(), false);
+  usable.assign(task.ops.size(), false);
+  vector<int> unsatisfied(task.ops.size());
+  vector<int> queue;
+  for(int i = 0; i < task.initial_facts.size(); i++) {
+    reached[task.initial_facts[i]] = true;
+    queue.push_back(task.initial_facts[i]);
+  }
+  vector<int> applicable;
+  for(int i = 0; i < task.ops.size(); i++) {
+    unsatisfied[i] = task.ops[i].pre.size();
+    if(unsatisfied[i] == 0)
+      applicable.push_back(i);
+  }
+  for(int head = 0; head < queue.size() || !applicable.empty();) {
+    if(applicable.empty()) {
+      const vector<int> &ops = task.ops_with_pre[queue[head++]];
+      for(int i = 0; i < ops.size(); i++)
+	if(--unsatisfied[ops[i]] == 0)
+	  applicable.push_back(ops[i]);
+      continue;
+    }
+    int op = applicable.back();
+    applicable.pop_back();
+    usable[op] = true;
+    if(binary_search(excluded_achievers.begin(), excluded_achievers.end(), op))
+      continue;
+    const vector<int> &adds = task.ops[op].adds;
+    for(int i = 0; i < adds.size(); i++)
+      if(!reached[adds[i]]) {
+	reached[adds[i]] = true;
+	queue.push_back(adds[i]);
+      }
+  }
+}
+
+// Whether target can be reached from source in the DTG given by arcs and
+// values_from_any (the targets of transitions from any value) without
+// passing through avoided.
+static bool is_connected(const vector<vector<int> > &arcs,
+			 const vector<int> &values_from_any,
+			 int source, int target, int avoided) {
+  vector<char> seen(arcs.size(), false);
+  vector<int> queue(1, source);
+  seen[source] = true;
+  for(int head = 0; head < queue.size(); head++) {
+    int value = queue[head];
+    if(value == target)
+      return true;
+    for(int pass = 0; pass < 2; pass++) {
+      const vector<int> &next = pass == 0 ? arcs[value] : values_from_any;
+      for(int i = 0; i < next.size(); i++)
+	if(next[i] != avoided && !seen[next[i]]) {
+	  seen[next[i]] = true;
+	  queue.push_back(next[i]);
+	}
+    }
+  }
+  return false;
+}
+
+struct LandmarkExpansion {
+  vector<int> shared_pre;  // greedy-necessary predecessors
+  vector<int> dtg_facts;   // natural predecessors
+};
+
+struct LandmarkJob {
+  const LandmarkTask *task;
+  const vector<int> *frontier;  // facts
+  vector<LandmarkExpansion> *results;
+};
+
+static void expand_landmark_job(int i, void *data) {
+  LandmarkJob *job = static_cast<LandmarkJob *>(data);
+  const LandmarkTask &task = *job->task;
+  int landmark = (*job->frontier)[i];
+  LandmarkExpansion &result = (*job->results)[i];
+  vector<char> reached, usable;
+  explore_without(task, landmark, reached, usable);
+
+  const vector<int> &achievers = task.achievers[landmark];
+  bool has_first_achiever = false;
+  for(int j = 0; j < achievers.size(); j++) {
+    if(!usable[achievers[j]])
+      continue;
+    const vector<int> &pre = task.ops[achievers[j]].pre;
+    if(!has_first_achiever) {
+      result.shared_pre = pre;
+      has_first_achiever = true;
+    } else {
+      vector<int> shared;
+      set_intersection(result.shared_pre.begin(), result.shared_pre.end(),
+		       pre.begin(), pre.end(), back_inserter(shared));
+      result.shared_pre.swap(shared);
+    }
+  }
+  // Without a possible first achiever the landmark is unreachable.
+  if(!has_first_achiever)
+    return;
+
+  const FactIndex &facts = *task.facts;
+  const Variable *var = facts.get_variable(landmark);
+  int target = facts.get_value(landmark);
+  int initial = task.initial_value[var->get_index()];
+  vector<vector<int> > arcs(var->get_range());
+  vector<int> values_from_any;
+  const vector<LandmarkArc> &var_arcs = task.arcs[var->get_index()];
+  for(int j = 0; j < var_arcs.size(); j++) {
+    const LandmarkArc &arc = var_arcs[j];
+    if(!usable[arc.op])
+      continue;
+    if(arc.source == -1)
+      values_from_any.push_back(arc.target);
+    else
+      arcs[arc.source].push_back(arc.target);
+  }
+  if(!is_connected(arcs, values_from_any, initial, target, -1))
+    return;
+  for(int value = 0; value < var->get_range(); value++)
+    if(value != initial && value != target &&
+       !is_connected(arcs, values_from_any, initial, target, value))
+      result.dtg_facts.push_back(facts.get_fact(var, value));
+}
+
+bool LandmarkGraph::Ordering::operator<(const Ordering &other) const {
+  if(from != other.from)
+    return from < other.from;
+  if(to != other.to)
+    return to < other.to;
+  return type < other.type;
+}
+
+LandmarkGraph::LandmarkGraph(const FactIndex &fact_index)
+  : facts(fact_index), computed(false) {
+}
+
+int LandmarkGraph::add_landmark(int fact) {
+  if(landmark_of_fact[fact] == -1) {
+    landmark_of_fact[fact] = landmarks.size();
+    landmarks.push_back(fact);
+  }
+  return landmark_of_fact[fact];
+}
+
+void LandmarkGraph::compute(const vector<Variable *> &variables,
+			    const vector<Operator> &operators,
+			    const State &initial_state,
+			    const vector<pair<Variable *, int> > &goals,
+			    const vector<Variable *> &shared_vars,
+			    const vector<pair<pair<Variable*, int>, vector<pair<pair<Variable*, int>, double> > > > &timed_goals) {
+  // Same variables as in H2Mutexes::compute.
+  vector<bool> analysed(variables.size(), true);
+  for(int i = 0; i < variables.size(); i++) {
+    Variable *var = variables[i];
+    if(var->is_derived() || var->get_level() == -1 || initial_state[var] == -1)
+      analysed[i] = false;
+  }
+  for(int i = 0; i < shared_vars.size(); i++)
+    analysed[shared_vars[i]->get_index()] = false;
+  for(int i = 0; i < timed_goals.size(); i++)
+    for(int j = 0; j < timed_goals[i].second.size(); j++)
+      analysed[timed_goals[i].second[j].first.first->get_index()] = false;
+  for(int i = 0; i < operators.size(); i++) {
+    Operator::PrePostRange numeric = operators[i].get_numeric_effects();
+    for(int j = 0; j < numeric.size(); j++)
+      analysed[numeric[j].var->get_index()] = false;
+  }
+
+  int num_facts = facts.get_num_facts();
+  LandmarkTask task;
+  task.facts = &facts;
+  task.ops.resize(operators.size());
+  task.achievers.resize(num_facts);
+  task.ops_with_pre.resize(num_facts);
+  task.arcs.resize(variables.size());
+  task.initial_value.assign(variables.size(), -1);
+  vector<char> initially_true(num_facts, false);
+  for(int i = 0; i < variables.size(); i++) {
+    int value = initial_state[variables[i]];
+    if(analysed[i] && value < variables[i]->get_range()) {
+      int fact = facts.get_fact(variables[i], value);
+      task.initial_facts.push_back(fact);
+      task.initial_value[i] = value;
+      initially_true[fact] = true;
+    }
+  }
+  for(int i = 0; i < operators.size(); i++) {
+    const Operator &op = operators[i];
+    RelaxedOperator &relaxed = task.ops[i];
+    for(int j = 0; j < op.get_prevail().size(); j++) {
+      Operator::Prevail prev = op.get_prevail()[j];
+      if(analysed[prev.var->get_index()])
+	relaxed.pre.push_back(facts.get_fact(prev.var, prev.prev));
+    }
+    Operator::PrePostRange ranges[2] = {op.get_propositional_effects(),
+					op.get_pre_block()};
+    for(int r = 0; r < 2; r++) {
+      for(int j = 0; j < ranges[r].size(); j++) {
+	Operator::PrePost eff = ranges[r][j];
+	if(!analysed[eff.var->get_index()])
+	  continue;
+	int source = -1;
+	if(r == 0 && eff.pre != PRE_ANY) {
+	  source = eff.pre;
+	  relaxed.pre.push_back(facts.get_fact(eff.var, eff.pre));
+	}
+	if(eff.post < 0 || eff.post >= eff.var->get_range())
+	  continue;
+	relaxed.adds.push_back(facts.get_fact(eff.var, eff.post));
+	task.arcs[eff.var->get_index()].push_back(LandmarkArc(i, source, eff.post));
+      }
+    }
+    sort(relaxed.pre.begin(), relaxed.pre.end());
+    relaxed.pre.erase(unique(relaxed.pre.begin(), relaxed.pre.end()),
+		      relaxed.pre.end());
+    sort(relaxed.adds.begin(), relaxed.adds.end());
+    relaxed.adds.erase(unique(relaxed.adds.begin(), relaxed.adds.end()),
+		       relaxed.adds.end());
+    for(int j = 0; j < relaxed.pre.size(); j++)
+      task.ops_with_pre[relaxed.pre[j]].push_back(i);
+    for(int j = 0; j < relaxed.adds.size(); j++)
+      task.achievers[relaxed.adds[j]].push_back(i);
+  }
+
+  landmarks.clear();
+  landmark_of_fact.assign(num_facts, -1);
+  orderings.clear();
+  vector<int> frontier;
+  for(int i = 0; i < goals.size(); i++) {
+    Variable *var = goals[i].first;
+    if(!analysed[var->get_index()] || goals[i].second >= var->get_range())
+      continue;
+    int fact = facts.get_fact(var, goals[i].second);
+    int old_size = landmarks.size();
+    add_landmark(fact);
+    if(landmarks.size() != old_size && !initially_true[fact])
+      frontier.push_back(fact);
+  }
+
+  // Each round expands the landmarks found in the previous one. The
+  // results are merged in order, so the numbering does not depend on
+  // the number of threads.
+  while(!frontier.empty()) {
+    vector<LandmarkExpansion> results(frontier.size());
+    LandmarkJob job;
+    job.task = &task;
+    job.frontier = &frontier;
+    job.results = &results;
+    parallel_for(0, frontier.size(), &expand_landmark_job, &job);
+
+    vector<int> next_frontier;
+    for(int i = 0; i < frontier.size(); i++) {
+      int to = landmark_of_fact[frontier[i]];
+      for(int type = GREEDY_NECESSARY; type <= NATURAL; type++) {
+	const vector<int> &found = type == GREEDY_NECESSARY ?
+	  results[i].shared_pre : results[i].dtg_facts;
+	for(int j = 0; j < found.size(); j++) {
+	  int old_size = landmarks.size();
+	  int from = add_landmark(found[j]);
+	  if(landmarks.size() != old_size && !initially_true[found[j]])
+	    next_frontier.push_back(found[j]);
+	  orderings.push_back(Ordering(from, to, type));
+	}
+      }
+    }
+    frontier.swap(next_frontier);
+  }
+
+  // Keep one ordering per pair of landmarks, preferring greedy-necessary.
+  sort(orderings.begin(), orderings.end());
+  vector<Ordering> unique_orderings;
+  for(int i = 0; i < orderings.size(); i++)
+    if(unique_orderings.empty() ||
+       unique_orderings.back().from != orderings[i].from ||
+       unique_orderings.back().to != orderings[i].to)
+      unique_orderings.push_back(orderings[i]);
+  orderings.swap(unique_orderings);
+  computed = true;
+  cout << landmarks.size() << " landmarks, " << orderings.size()
+       << " orderings" << endl;
+}
+
+void LandmarkGraph::generate_cpp_input(ostream &outfile) const {
+  outfile << "begin_landmarks" << endl;
+  outfile << landmarks.size() << endl;
+  for(int i = 0; i < landmarks.size(); i++)
+    outfile << facts.get_variable(landmarks[i])->get_level() << " "
+	    << facts.get_value(landmarks[i]) << endl;
+  outfile << orderings.size() << endl;
+  for(int i = 0; i < orderings.size(); i++)
+    outfile << orderings[i].from << " " << orderings[i].to << " "
+	    << orderings[i].type << endl;
+  outfile << "end_landmarks" << endl;
+}
@@ -0,0 +1,93 @@
+/*********************************************************************
+ * This file is part of LAMA.
+ *
+ * LAMA is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the license, or (at your option) any later version.
+ *
+ * LAMA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ *********************************************************************/
+
+#ifndef LANDMARKS_H
+#define LANDMARKS_H
+
+/*
+  Fact landmarks: facts that are true at some point of every plan.
+
+  Landmarks are found by backchaining from the goals. For a landmark L
+  that is false initially, the facts reachable in the delete relaxation
+  without the operators that can achieve L are computed. The achievers
+  whose preconditions are among these facts are the possible first
+  achievers of L, and the operators whose preconditions are among them
+  are the ones that can be used before L is reached. Then
+  - the preconditions shared by all possible first achievers are
+    landmarks, ordered greedy-necessarily before L, and
+  - every value of L's variable that lies on all paths from its initial
+    value to L in the DTG, restricted to transitions of the usable
+    operators, is a landmark, ordered naturally before L.
+
+  The same variables as in the h^2 mutex analysis are considered (see
+  h2_mutexes.h): conditions on the others are ignored and they get no
+  landmarks. Effect conditions are ignored as well, and conditional and
+  blocking effects count as achievers. All this only makes more facts
+  reachable, so every landmark found holds in every plan of this agent.
+
+  The landmarks found in one round of backchaining are expanded in
+  parallel. The result is written after the main output:
+
+    begin_landmarks
+    <number of landmarks>
+    <level> <value>          (landmark i; goals first)
+    ...
+    <number of orderings>
+    <from> <to> <type>       (landmark numbers; type 0 is greedy-necessary,
+    ...                       1 is natural)
+    end_landmarks
+*/
+
+#include <fstream>
+#include <vector>
+using namespace std;
+
+class FactIndex;
+class Operator;
+class State;
+class Variable;
+
+extern bool g_landmarks;
+
+class LandmarkGraph {
+  const FactIndex &facts;
+  vector<int> landmarks;         // fact IDs
+  vector<int> landmark_of_fact;  // or -1
+  struct Ordering {
+    int from, to, type;
+    Ordering(int f, int t, int ty) : from(f), to(t), type(ty) {}
+    bool operator<(const Ordering &other) const;
+  };
+  vector<Ordering> orderings;
+  bool computed;
+
+  int add_landmark(int fact);
+public:
+  enum {GREEDY_NECESSARY = 0, NATURAL = 1};
+  LandmarkGraph(const FactIndex &facts);
+  void compute(const vector<Variable *> &variables,
+	       const vector<Operator> &operators,
+	       const State &initial_state,
+	       const vector<pair<Variable *, int> > &goals,
+	       const vector<Variable *> &shared_vars,
+	       const vector<pair<pair<Variable*, int>, vector<pair<pair<Variable*, int>, double> > > > &timed_goals);
+  bool is_computed() const {return computed;}
+  void generate_cpp_input(ostream &outfile) const;
+};
+
+#endif
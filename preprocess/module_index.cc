@@ -0,0 +1,206 @@
+/*********************************************************************
+ * This file is part of LAMA.
+ *
+ * LAMA is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the license, or (at your option) any later version.
+ *
+ * LAMA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ *********************************************************************/
+
+#include "module_index.h"
+#include "operator.h"
+#include "variable.h"
+
+#include <cctype>
+#include <iostream>
+#include <sstream>
+using namespace std;
+
+bool g_resolve_modules = false;
+
+static void skip_spaces(const string &text, size_t &pos) {
+  while(pos < text.size() && isspace(static_cast<unsigned char>(text[pos])))
+    pos++;
+}
+
+// Reads a module, function or argument name: everything up to one of the
+// given delimiters or a space.
+static string read_name(const string &text, size_t &pos, const char *delimiters) {
+  size_t start = pos;
+  while(pos < text.size() && !isspace(static_cast<unsigned char>(text[pos])) &&
+	string(delimiters).find(text[pos]) == string::npos)
+    pos++;
+  return text.substr(start, pos - start);
+}
+
+bool ModuleIndex::parse_call(const string &reference, int num_variables,
+			     Call &call, string &error) const {
+  size_t pos = 0;
+  skip_spaces(reference, pos);
+  string module = read_name(reference, pos, ".(),");
+  skip_spaces(reference, pos);
+  if(module.empty() || pos == reference.size() || reference[pos] != '.') {
+    error = "expected <module>.<function>";
+    return false;
+  }
+  pos++;
+  skip_spaces(reference, pos);
+  string function = read_name(reference, pos, ".(),");
+  skip_spaces(reference, pos);
+  if(function.empty()) {
+    error = "missing function name";
+    return false;
+  }
+
+  map<string, int>::const_iterator module_it = module_ids.find(module);
+  if(module_it == module_ids.end()) {
+    error = "unknown module '" + module + "'";
+    return false;
+  }
+  call.module = module_it->second;
+  const map<string, int> &functions = function_ids[call.module];
+  map<string, int>::const_iterator function_it = functions.find(function);
+  if(function_it == functions.end()) {
+    error = "unknown function '" + function + "' of module '" + module + "'";
+    return false;
+  }
+  call.function = function_it->second;
+
+  call.arguments.clear();
+  if(pos < reference.size()) {
+    if(reference[pos] != '(') {
+      error = "expected '('";
+      return false;
+    }
+    pos++;
+    skip_spaces(reference, pos);
+    if(pos < reference.size() && reference[pos] == ')') {
+      pos++;
+    } else {
+      while(true) {
+	skip_spaces(reference, pos);
+	string text = read_name(reference, pos, "(),");
+	if(text.empty()) {
+	  error = "missing argument";
+	  return false;
+	}
+	Argument arg;
+	arg.text = text;
+	arg.var = -1;
+	if(text[0] == '!') {
+	  arg.kind = Argument::VARIABLE;
+	  bool valid = text.size() > 2 && text[text.size() - 1] == '!';
+	  int var = 0;
+	  for(size_t i = 1; valid && i + 1 < text.size(); i++) {
+	    valid = isdigit(static_cast<unsigned char>(text[i])) && var < num_variables;
+	    var = var * 10 + (text[i] - '0');
+	  }
+	  if(!valid || var >= num_variables) {
+	    error = "invalid variable reference '" + text + "'";
+	    return false;
+	  }
+	  arg.var = var;
+	} else if(isdigit(static_cast<unsigned char>(text[0])) ||
+		  text[0] == '-' || text[0] == '.') {
+	  arg.kind = Argument::CONSTANT;
+	} else {
+	  arg.kind = Argument::NAME;
+	}
+	call.arguments.push_back(arg);
+	skip_spaces(reference, pos);
+	if(pos < reference.size() && reference[pos] == ',') {
+	  pos++;
+	} else if(pos < reference.size() && reference[pos] == ')') {
+	  pos++;
+	  break;
+	} else {
+	  error = "expected ',' or ')'";
+	  return false;
+	}
+      }
+    }
+    skip_spaces(reference, pos);
+    if(pos != reference.size()) {
+      error = "unexpected text after ')'";
+      return false;
+    }
+  }
+
+  int arity = function_arities[call.module][call.function];
+  if(call.arguments.size() != arity) {
+    ostringstream message;
+    message << "function '" << module << "." << function << "' takes "
+	    << arity << " arguments, got " << call.arguments.size();
+    error = message.str();
+    return false;
+  }
+  return true;
+}
+
+bool ModuleIndex::resolve(const Modules &modules,
+			  const vector<Operator> &operators,
+			  const vector<Variable *> &variables) {
+  module_ids.clear();
+  function_ids.assign(modules.size(), map<string, int>());
+  function_arities.assign(modules.size(), vector<int>());
+  for(int i = 0; i < modules.size(); i++) {
+    // Like any lookup by name, a repeated name refers to the first entry.
+    module_ids.insert(make_pair(modules[i].first, i));
+    for(int j = 0; j < modules[i].second.size(); j++) {
+      function_ids[i].insert(make_pair(modules[i].second[j].first, j));
+      function_arities[i].push_back(modules[i].second[j].second.size());
+    }
+  }
+
+  calls.clear();
+  bool ok = true;
+  Call call;
+  string error;
+  for(int i = 0; i < operators.size(); i++) {
+    if(!operators[i].has_module_cost())
+      continue;
+    string reference = operators[i].get_module_call();
+    if(parse_call(reference, variables.size(), call, error)) {
+      call.op = i;
+      calls.push_back(call);
+    } else {
+      cout << "Malformed modulefunc reference '" << reference
+	   << "' in operator '" << operators[i].get_name() << "': "
+	   << error << "." << endl;
+      ok = false;
+    }
+  }
+  resolved = ok;
+  return ok;
+}
+
+void ModuleIndex::generate_cpp_input(ostream &outfile,
+				     const vector<Variable *> &variables) const {
+  outfile << "begin_module_index" << endl;
+  outfile << calls.size() << endl;
+  for(int i = 0; i < calls.size(); i++) {
+    const Call &call = calls[i];
+    outfile << call.op << " " << call.module << " " << call.function
+	    << " " << call.arguments.size();
+    for(int j = 0; j < call.arguments.size(); j++) {
+      const Argument &arg = call.arguments[j];
+      if(arg.kind == Argument::VARIABLE)
+	outfile << " v " << variables[arg.var]->get_level();
+      else if(arg.kind == Argument::CONSTANT)
+	outfile << " c " << arg.text;
+      else
+	outfile << " o " << arg.text;
+    }
+    outfile << endl;
+  }
+  outfile << "end_module_index" << endl;
+}
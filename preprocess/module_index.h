@@ -0,0 +1,90 @@
+/*********************************************************************
+ * This file is part of LAMA.
+ *
+ * LAMA is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the license, or (at your option) any later version.
+ *
+ * LAMA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ *********************************************************************/
+
+#ifndef MODULE_INDEX_H
+#define MODULE_INDEX_H
+
+/*
+  Resolution of "modulefunc" operator costs against the modules of the
+  task. A reference has the form
+
+    <module>.<function>(<argument>, ...)
+
+  where spaces are allowed between the parts and "()" may be left out for
+  functions without arguments. An argument is a variable reference !<var>!,
+  a number or a name (e.g. an object). Modules and functions are numbered
+  by their position in the modules section, and references are resolved
+  to (module, function, argument bindings). The resolved references are
+  written after end_modules as
+
+    begin_module_index
+    <number of references>
+    <operator> <module> <function> <number of arguments> <argument>...
+    ...
+    end_module_index
+
+  with an argument written as "v <level>", "c <number>" or "o <name>".
+*/
+
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+using namespace std;
+
+class Operator;
+class Variable;
+
+extern bool g_resolve_modules;
+
+class ModuleIndex {
+public:
+  typedef vector<pair<string, vector<pair<string, vector<pair<string, string> > > > > > Modules;
+  struct Argument {
+    enum Kind {VARIABLE, CONSTANT, NAME};
+    Kind kind;
+    int var;      // index of the variable
+    string text;  // the number or name as written
+  };
+  struct Call {
+    int op;
+    int module;
+    int function;
+    vector<Argument> arguments;
+  };
+private:
+  map<string, int> module_ids;
+  vector<map<string, int> > function_ids;
+  vector<vector<int> > function_arities;
+  vector<Call> calls;
+  bool resolved;
+
+  bool parse_call(const string &reference, int num_variables, Call &call,
+		  string &error) const;
+public:
+  ModuleIndex() : resolved(false) {}
+  // Resolves the modulefunc references of all operators. Reports each
+  // malformed reference and returns false if there is any.
+  bool resolve(const Modules &modules, const vector<Operator> &operators,
+	       const vector<Variable *> &variables);
+  bool is_resolved() const {return resolved;}
+  void generate_cpp_input(ostream &outfile,
+			  const vector<Variable *> &variables) const;
+};
+
+#endif
@@ -0,0 +1,230 @@
+/*********************************************************************
+ * This file is part of LAMA.
+ *
+ * LAMA is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the license, or (at your option) any later version.
+ *
+ * LAMA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ *********************************************************************/
+
+#include "numeric_bounds.h"
+#include "cost_bytecode.h"
+#include "operator.h"
+#include "state.h"
+#include "variable.h"
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+using namespace std;
+
+bool g_numeric_bounds = false;
+
+// Rounds in which bounds may move before they are widened.
+static const int WIDENING_DELAY = 3;
+
+// A numeric effect on a tracked variable, with its amount compiled.
+struct BoundedEffect {
+  int var;
+  int pre;
+  int code;      // index into the compiled amounts, or -1
+  double amount; // if there is no compiled amount
+  bool known;    // false if the amount could not be compiled
+};
+
+NumericBounds::Interval NumericBounds::unbounded() {
+  double inf = numeric_limits<double>::infinity();
+  return Interval(-inf, inf);
+}
+
+NumericBounds::Interval NumericBounds::join(const Interval &i1, const Interval &i2) {
+  return Interval(min(i1.lower, i2.lower), max(i1.upper, i2.upper));
+}
+
+static double product(double x, double y) {
+  // 0 * inf is taken to be 0: a bound of 0 is exact, the infinite one is not.
+  return (x == 0 || y == 0) ? 0 : x * y;
+}
+
+NumericBounds::Interval NumericBounds::multiply(const Interval &i1, const Interval &i2) {
+  double p1 = product(i1.lower, i2.lower), p2 = product(i1.lower, i2.upper);
+  double p3 = product(i1.upper, i2.lower), p4 = product(i1.upper, i2.upper);
+  return Interval(min(min(p1, p2), min(p3, p4)), max(max(p1, p2), max(p3, p4)));
+}
+
+NumericBounds::Interval NumericBounds::apply(int pre, const Interval &value,
+					     const Interval &amount) {
+  Interval result;
+  switch(pre) {
+  case -2: // assign
+    result = amount;
+    break;
+  case -3: // increase
+    result = Interval(value.lower + amount.lower, value.upper + amount.upper);
+    break;
+  case -4: // decrease
+    result = Interval(value.lower - amount.upper, value.upper - amount.lower);
+    break;
+  case -5: // scale-up
+    result = multiply(value, amount);
+    break;
+  default: // scale-down
+    if(amount.lower <= 0 && amount.upper >= 0)
+      return unbounded();
+    result = multiply(value, Interval(1 / amount.upper, 1 / amount.lower));
+    break;
+  }
+  // inf - inf and the like
+  if(result.lower != result.lower || result.upper != result.upper)
+    return unbounded();
+  return result;
+}
+
+NumericBounds::Interval NumericBounds::evaluate(const vector<CostInstruction> &code) const {
+  vector<Interval> stack;
+  for(int i = 0; i < code.size(); i++) {
+    const CostInstruction &instr = code[i];
+    if(instr.code == CostInstruction::CONSTANT) {
+      stack.push_back(Interval(instr.value, instr.value));
+      continue;
+    } else if(instr.code == CostInstruction::VARIABLE) {
+      int level = int(instr.value);
+      if(level >= 0 && level < numeric_of_level.size() &&
+	 numeric_of_level[level] != -1)
+	stack.push_back(bounds[numeric_of_level[level]]);
+      else
+	stack.push_back(unbounded());
+      continue;
+    } else if(instr.code == CostInstruction::NEG) {
+      Interval &top = stack.back();
+      top = Interval(-top.upper, -top.lower);
+      continue;
+    }
+    Interval right = stack.back();
+    stack.pop_back();
+    Interval left = stack.back();
+    switch(instr.code) {
+    case CostInstruction::ADD: stack.back() = apply(-3, left, right); break;
+    case CostInstruction::SUB: stack.back() = apply(-4, left, right); break;
+    case CostInstruction::MUL: stack.back() = apply(-5, left, right); break;
+    default: stack.back() = apply(-6, left, right); break;
+    }
+  }
+  return stack.back();
+}
+
+void NumericBounds::compute(const vector<Variable *> &variables,
+			    const vector<Operator> &operators,
+			    const State &initial_state,
+			    const vector<Variable *> &shared_vars) {
+  int num_levels = 0;
+  for(int i = 0; i < variables.size(); i++)
+    num_levels = max(num_levels, variables[i]->get_level() + 1);
+  numeric_of_level.assign(num_levels, -1);
+  vector<int> numeric_of_var(variables.size(), -1);
+  for(int i = 0; i < variables.size(); i++) {
+    Variable *var = variables[i];
+    if(var->get_level() == -1 || initial_state[var] != -1)
+      continue;
+    numeric_of_level[var->get_level()] = numeric_vars.size();
+    numeric_of_var[i] = numeric_vars.size();
+    numeric_vars.push_back(var);
+    double value = initial_state.get_numeric_value(var);
+    bounds.push_back(Interval(value, value));
+  }
+  for(int i = 0; i < shared_vars.size(); i++)
+    if(numeric_of_var[shared_vars[i]->get_index()] != -1)
+      bounds[numeric_of_var[shared_vars[i]->get_index()]] = unbounded();
+
+  vector<BoundedEffect> effects;
+  vector<vector<CostInstruction> > codes;
+  vector<CostInstruction> code;
+  for(int i = 0; i < operators.size(); i++) {
+    const Operator &op = operators[i];
+    Operator::PrePostRange numeric = op.get_numeric_effects();
+    for(int j = 0; j < numeric.size(); j++) {
+      int var = numeric_of_var[numeric[j].var->get_index()];
+      if(var == -1)
+	continue;
+      const OperatorArena::NumericEffect &num = op.get_numeric_effect(j);
+      BoundedEffect effect;
+      effect.var = var;
+      effect.pre = numeric[j].pre;
+      effect.code = -1;
+      effect.amount = num.f_cost;
+      effect.known = true;
+      if(num.expression != -1) {
+	if(compile_cost_expression(op.get_arena(), num.expression, variables, code)) {
+	  effect.code = codes.size();
+	  codes.push_back(code);
+	} else {
+	  effect.known = false;
+	}
+      }
+      effects.push_back(effect);
+    }
+  }
+
+  bool changed = true;
+  for(int round = 0; changed; round++) {
+    changed = false;
+    for(int i = 0; i < effects.size(); i++) {
+      const BoundedEffect &effect = effects[i];
+      Interval amount(effect.amount, effect.amount);
+      if(!effect.known)
+	amount = unbounded();
+      else if(effect.code != -1)
+	amount = evaluate(codes[effect.code]);
+      Interval &value = bounds[effect.var];
+      Interval result = join(value, apply(effect.pre, value, amount));
+      if(round >= WIDENING_DELAY) {
+	if(result.lower < value.lower)
+	  result.lower = -numeric_limits<double>::infinity();
+	if(result.upper > value.upper)
+	  result.upper = numeric_limits<double>::infinity();
+      }
+      if(result.lower != value.lower || result.upper != value.upper) {
+	value = result;
+	changed = true;
+      }
+    }
+  }
+  computed = true;
+}
+
+static void write_bound(ostream &outfile, double bound) {
+  if(bound == numeric_limits<double>::infinity())
+    outfile << "inf";
+  else if(bound == -numeric_limits<double>::infinity())
+    outfile << "-inf";
+  else
+    outfile << bound;
+}
+
+void NumericBounds::generate_cpp_input(ostream &outfile) const {
+  // Bounds are written so that they read back exactly.
+  streamsize old_precision = outfile.precision(17);
+  outfile << "begin_numeric_bounds" << endl;
+  outfile << numeric_vars.size() << endl;
+  for(int level = 0; level < numeric_of_level.size(); level++) {
+    int var = numeric_of_level[level];
+    if(var == -1)
+      continue;
+    outfile << level << " ";
+    write_bound(outfile, bounds[var].lower);
+    outfile << " ";
+    write_bound(outfile, bounds[var].upper);
+    outfile << endl;
+  }
+  outfile << "end_numeric_bounds" << endl;
+  outfile.precision(old_precision);
+}
@@ -0,0 +1,84 @@
+/*********************************************************************
+ * This file is part of LAMA.
+ *
+ * LAMA is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the license, or (at your option) any later version.
+ *
+ * LAMA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ *********************************************************************/
+
+#ifndef NUMERIC_BOUNDS_H
+#define NUMERIC_BOUNDS_H
+
+/*
+  Interval bounds of the numeric variables.
+
+  Starting from the initial values, the numeric effects of all operators
+  are applied to intervals until nothing changes: assign (-2) joins the
+  interval with the assigned amount, increase (-3), decrease (-4),
+  scale-up (-5) and scale-down (-6) join it with the result of the
+  operation. Amounts given by cost expressions are evaluated on the
+  current intervals. After a few rounds, a bound that still moves is
+  widened to infinity, so the analysis always terminates. Shared numeric
+  variables can be changed by other agents and are unbounded.
+
+  Operators are not pruned: the input has no numeric preconditions, so
+  every operator is assumed to be applicable in every round. The bounds
+  are written after the main output:
+
+    begin_numeric_bounds
+    <number of numeric variables>
+    <level> <lower bound> <upper bound>
+    ...
+    end_numeric_bounds
+
+  with "-inf" and "inf" for missing bounds.
+*/
+
+#include <fstream>
+#include <vector>
+using namespace std;
+
+struct CostInstruction;
+class Operator;
+class State;
+class Variable;
+
+extern bool g_numeric_bounds;
+
+class NumericBounds {
+  struct Interval {
+    double lower, upper;
+    Interval() : lower(0), upper(0) {}
+    Interval(double l, double u) : lower(l), upper(u) {}
+  };
+  vector<int> numeric_of_level;  // index into bounds, or -1
+  vector<Variable *> numeric_vars;
+  vector<Interval> bounds;
+  bool computed;
+
+  static Interval unbounded();
+  static Interval join(const Interval &i1, const Interval &i2);
+  static Interval multiply(const Interval &i1, const Interval &i2);
+  static Interval apply(int pre, const Interval &value, const Interval &amount);
+  Interval evaluate(const vector<CostInstruction> &code) const;
+public:
+  NumericBounds() : computed(false) {}
+  void compute(const vector<Variable *> &variables,
+	       const vector<Operator> &operators,
+	       const State &initial_state,
+	       const vector<Variable *> &shared_vars);
+  bool is_computed() const {return computed;}
+  void generate_cpp_input(ostream &outfile) const;
+};
+
+#endif
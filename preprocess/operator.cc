@@ -25,92 +25,146 @@
 #include "operator.h"
 #include "variable.h"
 
+#include <algorithm>
 #include <cassert>
 #include <iostream>
 #include <fstream>
 #include <sstream>
 using namespace std;
 
-Operator::Operator(istream &in, const vector<Variable *> &variables) {
+bool g_renumber_operators = false;
+
+void OperatorArena::add_effect(Variable *var, int pre, int post, int numeric,
+			       const vector<pair<Variable *, int> > &conds) {
+  effect_vars.push_back(var);
+  effect_pres.push_back(pre);
+  effect_posts.push_back(post);
+  effect_numeric.push_back(numeric);
+  for(int i = 0; i < conds.size(); i++) {
+    effect_cond_vars.push_back(conds[i].first);
+    effect_cond_vals.push_back(conds[i].second);
+  }
+  effect_cond_begin.push_back(effect_cond_vars.size());
+}
+
+Operator::Operator(istream &in, const vector<Variable *> &variables,
+		   OperatorArena &the_arena, int index)
+  : arena(&the_arena), input_index(index) {
   check_magic(in, "begin_operator");
   in >> ws;
+  string name;
   getline(in, name);
+  name_begin = arena->names.size();
+  arena->names.insert(arena->names.end(), name.begin(), name.end());
+  name_end = arena->names.size();
   int count; // number of prevail conditions
   in >> count;
+  prevail_begin = arena->prevail_vars.size();
   for(int i = 0; i < count; i++) {
     int varNo, val;
     in >> varNo >> val;
-    prevail.push_back(Prevail(variables[varNo], val));
+    arena->prevail_vars.push_back(variables[varNo]);
+    arena->prevail_vals.push_back(val);
   }
+  prevail_end = arena->prevail_vars.size();
   in >> count; // number of pre_post conditions
+  // Propositional effects go to the arena directly; the numeric and
+  // blocking effects are appended after them.
+  effect_begin = arena->effect_vars.size();
+  conditional_effects = false;
+  vector<pair<Variable *, int> > ecs;
+  vector<pair<Variable *, pair<int, int> > > numerics, blocks;
+  vector<vector<pair<Variable *, int> > > numeric_conds, block_conds;
+  vector<OperatorArena::NumericEffect> numeric_costs;
+  int position = 0; // among the pre_post effects
   for(int i = 0; i < count; i++) {
     int eff_conds;
-    vector<EffCond> ecs;
+    ecs.clear();
     in >> eff_conds;
     for(int j = 0; j < eff_conds; j++) {
       int var, value;
       in >> var >> value;
-      ecs.push_back(EffCond(variables[var], value));
+      ecs.push_back(make_pair(variables[var], value));
     }
+    if(eff_conds)
+      conditional_effects = true;
     int varNo, val, newVal;
     string funcCost;
     float f_funcCost = 0;
     in >> varNo >> val;
-    if (val == -7 || val == -8){
+    if (is_blocking_pre(val)){
             in >> newVal;
-            if(eff_conds)
-              pre_block.push_back(PrePost(variables[varNo], ecs, val, newVal, float(-1)));
-            else
-              pre_block.push_back(PrePost(variables[varNo], val, newVal, float(-1)));
+            blocks.push_back(make_pair(variables[varNo], make_pair(val, newVal)));
+            block_conds.push_back(ecs);
     }
-    else if(val != -2 && (val != -3) && (val != -4) && (val != -5) && (val != -6))
+    else if(!is_numeric_pre(val))
     {
         in >> newVal;
-        if(eff_conds)
-          pre_post.push_back(PrePost(variables[varNo], ecs, val, newVal, float(-1)));
-        else
-          pre_post.push_back(PrePost(variables[varNo], val, newVal, float(-1)));
+        arena->add_effect(variables[varNo], val, newVal, -1, ecs);
+        position++;
     }
     else
     {
     	in >> funcCost >> varNo >> newVal;
+    	int expression = -1;
     	if (funcCost.find('(') == std::string::npos)
     	{
             istringstream buffer(funcCost);
             buffer >> f_funcCost;
-            if(eff_conds)
-              pre_post.push_back(PrePost(variables[varNo], ecs, val, newVal, f_funcCost));
-            else
-              pre_post.push_back(PrePost(variables[varNo], val, newVal, f_funcCost));
     	} else{
-            if(eff_conds)
-              pre_post.push_back(PrePost(variables[varNo], ecs, val, newVal, float(0),funcCost));
-            else
-              pre_post.push_back(PrePost(variables[varNo], val, newVal, float(0), funcCost));
+            expression = arena->add_cost_expression(funcCost, variables.size());
     	}
+    	numerics.push_back(make_pair(variables[varNo], make_pair(val, newVal)));
+    	numeric_conds.push_back(ecs);
+    	numeric_costs.push_back(
+    	  OperatorArena::NumericEffect(f_funcCost, expression, position++));
     }
 
   }
+  numeric_begin = arena->effect_vars.size();
+  for(int i = 0; i < numerics.size(); i++) {
+    arena->add_effect(numerics[i].first, numerics[i].second.first,
+		      numerics[i].second.second, arena->numeric_effects.size(),
+		      numeric_conds[i]);
+    arena->numeric_effects.push_back(numeric_costs[i]);
+  }
+  block_begin = arena->effect_vars.size();
+  for(int i = 0; i < blocks.size(); i++)
+    arena->add_effect(blocks[i].first, blocks[i].second.first,
+		      blocks[i].second.second, -1, block_conds[i]);
+  effect_end = arena->effect_vars.size();
   in >> cost;
   string s_aux = "";
   in >> s_aux;
+  runtime_cost = -1;
   if(s_aux == "runtime"){
-	  have_runtime_cost = true;
-	  in >> runtime_cost;
+	  cost_kind = RUNTIME_COST;
+	  string expression;
+	  in >> expression;
+	  runtime_cost = arena->add_cost_expression(expression, variables.size());
   } else if (s_aux == "modulefunc"){
-	  have_module_cost = true;
-	  in >> runtime_cost;
+	  cost_kind = MODULE_COST;
+	  string expression;
+	  in >> expression;
+	  // Module calls are written as they are read, so keep them as text.
+	  runtime_cost = arena->add_cost_expression(expression, 0);
 	  cout << name << endl;
   } else {
-	  have_runtime_cost = false;
-	  have_module_cost = false;
+	  cost_kind = NO_RUNTIME_COST;
 	  in >> s_aux;
   }
   check_magic(in, "end_operator");
 }
 
+string Operator::get_name() const {
+  return string(arena->names.begin() + name_begin,
+		arena->names.begin() + name_end);
+}
+
 void Operator::dump() const {
-  cout << name << ":" << endl;
+  PrevailRange prevail = get_prevail();
+  PrePostRange pre_post = get_pre_post();
+  cout << get_name() << ":" << endl;
   cout << "prevail:";
   for(int i = 0; i < prevail.size(); i++)
     cout << "  " << prevail[i].var->get_name() << " := " << prevail[i].prev;
@@ -130,142 +184,253 @@ void Operator::dump() const {
   cout << endl;
 }
 
-void Operator::strip_unimportant_effects() {
-  int new_index = 0;
-  for(int i = 0; i < pre_post.size(); i++) {
-    if(pre_post[i].var->get_level() != -1)
-      pre_post[new_index++] = pre_post[i];
-  }
-  pre_post.erase(pre_post.begin() + new_index, pre_post.end());
+bool Operator::is_redundant() const {
+  return block_begin == effect_begin;
 }
 
-bool Operator::is_redundant() const {
-  return pre_post.empty();
+// Truncates vec to its first size elements and releases the spare capacity.
+template<class T>
+static void shrink(vector<T> &vec, int size) {
+  vector<T>(vec.begin(), vec.begin() + size).swap(vec);
 }
 
 void strip_operators(vector<Operator> &operators) {
   int old_count = operators.size();
+  if(operators.empty()) {
+    cout << operators.size() << " of " << old_count << " operators necessary." << endl;
+    return;
+  }
+  // All operators share one arena and are laid out in it in order, so
+  // moving the kept entries to the front never overwrites unread ones.
+  OperatorArena &arena = *operators[0].arena;
   int new_index = 0;
+  int names = 0, prevails = 0, effects = 0, conds = 0, numerics = 0;
   for(int i = 0; i < operators.size(); i++) {
-    operators[i].strip_unimportant_effects();
-    if(!operators[i].is_redundant())
-      operators[new_index++] = operators[i];
+    Operator op = operators[i];
+    assert(op.arena == &arena);
+    // Remove unnecessary effects (on unimportant variables)
+    bool redundant = true;
+    for(int j = op.effect_begin; j < op.block_begin; j++)
+      if(arena.effect_vars[j]->get_level() != -1)
+	redundant = false;
+    if(redundant)
+      continue;
+
+    int name_begin = names;
+    for(int j = op.name_begin; j < op.name_end; j++)
+      arena.names[names++] = arena.names[j];
+    op.name_begin = name_begin;
+    op.name_end = names;
+
+    int prevail_begin = prevails;
+    for(int j = op.prevail_begin; j < op.prevail_end; j++) {
+      arena.prevail_vars[prevails] = arena.prevail_vars[j];
+      arena.prevail_vals[prevails++] = arena.prevail_vals[j];
+    }
+    op.prevail_begin = prevail_begin;
+    op.prevail_end = prevails;
+
+    // Number the kept numeric effects by their position among the kept
+    // pre_post effects, walking those in input order.
+    int prop = op.effect_begin, num = op.numeric_begin, kept = 0;
+    for(int pos = 0; prop < op.numeric_begin || num < op.block_begin; pos++) {
+      int j;
+      if(num < op.block_begin &&
+	 arena.numeric_effects[arena.effect_numeric[num]].position == pos)
+	j = num++;
+      else
+	j = prop++;
+      if(arena.effect_vars[j]->get_level() == -1)
+	continue;
+      if(j >= op.numeric_begin)
+	arena.numeric_effects[arena.effect_numeric[j]].position = kept;
+      kept++;
+    }
+
+    int effect_begin = effects, numeric_begin = effects, block_begin = effects;
+    for(int j = op.effect_begin; j < op.effect_end; j++) {
+      if(j == op.numeric_begin)
+	numeric_begin = effects;
+      if(j == op.block_begin)
+	block_begin = effects;
+      if(j < op.block_begin && arena.effect_vars[j]->get_level() == -1)
+	continue;
+      // effects <= j, so the condition range of effect j is still intact.
+      int cond_begin = arena.effect_cond_begin[j];
+      int cond_end = arena.effect_cond_begin[j + 1];
+      arena.effect_cond_begin[effects] = conds;
+      for(int k = cond_begin; k < cond_end; k++) {
+	arena.effect_cond_vars[conds] = arena.effect_cond_vars[k];
+	arena.effect_cond_vals[conds++] = arena.effect_cond_vals[k];
+      }
+      arena.effect_vars[effects] = arena.effect_vars[j];
+      arena.effect_pres[effects] = arena.effect_pres[j];
+      arena.effect_posts[effects] = arena.effect_posts[j];
+      int numeric = arena.effect_numeric[j];
+      if(numeric != -1) {
+	arena.numeric_effects[numerics] = arena.numeric_effects[numeric];
+	numeric = numerics++;
+      }
+      arena.effect_numeric[effects++] = numeric;
+    }
+    if(op.numeric_begin == op.effect_end)
+      numeric_begin = effects;
+    if(op.block_begin == op.effect_end)
+      block_begin = effects;
+    op.effect_begin = effect_begin;
+    op.numeric_begin = numeric_begin;
+    op.block_begin = block_begin;
+    op.effect_end = effects;
+    operators[new_index++] = op;
   }
   operators.erase(operators.begin() + new_index, operators.end());
+  shrink(arena.names, names);
+  shrink(arena.prevail_vars, prevails);
+  shrink(arena.prevail_vals, prevails);
+  shrink(arena.effect_vars, effects);
+  shrink(arena.effect_pres, effects);
+  shrink(arena.effect_posts, effects);
+  shrink(arena.effect_numeric, effects);
+  arena.effect_cond_begin[effects] = conds;
+  shrink(arena.effect_cond_begin, effects + 1);
+  shrink(arena.effect_cond_vars, conds);
+  shrink(arena.effect_cond_vals, conds);
+  shrink(arena.numeric_effects, numerics);
+  // Only needed to share literals while reading.
+  map<string, int>().swap(arena.literal_tokens);
   cout << operators.size() << " of " << old_count << " operators necessary." << endl;
 }
 
-void Operator::generate_cpp_input(ofstream &outfile, vector<Variable *> variables) const {
-  outfile << "begin_operator" << endl;
-  outfile << name << endl;
-
-  outfile << prevail.size() << endl;
-  for(int i = 0; i < prevail.size(); i++) {
-    assert(prevail[i].var->get_level() != -1);
-    if(prevail[i].var->get_level() != -1)
-      outfile << prevail[i].var->get_level() << " "<< prevail[i].prev << endl;
-  }
+int OperatorArena::get_literal_token(const string &literal) {
+  int token = -int(expression_literals.size()) - 1;
+  map<string, int>::iterator it = literal_tokens.insert(make_pair(literal, token)).first;
+  if(it->second == token)
+    expression_literals.push_back(literal);
+  return it->second;
+}
 
-  outfile << pre_post.size() << endl;
-  for(int i = 0; i < pre_post.size(); i++) { 
-    assert(pre_post[i].var->get_level() != -1);
-    if(pre_post[i].is_conditional_effect) {
-      outfile << pre_post[i].effect_conds.size() << endl;
-      for(int j = 0; j < pre_post[i].effect_conds.size(); j++)
-	outfile << pre_post[i].effect_conds[j].var->get_level() << " " <<
-	  pre_post[i].effect_conds[j].cond << endl;
-    } else {
-      outfile << "0" << endl;
+// Splits an expression into literal text and variable references "!<var>!".
+// A '!' that does not start a reference to one of the num_variables
+// variables is kept as text.
+int OperatorArena::add_cost_expression(const string &text, int num_variables) {
+  string literal;
+  size_t pos = 0;
+  while(pos < text.size()) {
+    size_t open = text.find('!', pos);
+    size_t close = open == string::npos ? string::npos : text.find('!', open + 1);
+    if(close == string::npos) {
+      literal.append(text, pos, string::npos);
+      break;
+    }
+    literal.append(text, pos, open - pos);
+    int var = 0;
+    bool is_reference = close > open + 1;
+    for(size_t i = open + 1; is_reference && i < close; i++) {
+      is_reference = text[i] >= '0' && text[i] <= '9' && var < num_variables;
+      var = var * 10 + (text[i] - '0');
     }
+    if(!is_reference || var >= num_variables) {
+      literal += '!';
+      pos = open + 1;
+      continue;
+    }
+    if(!literal.empty()) {
+      expression_tokens.push_back(get_literal_token(literal));
+      literal.clear();
+    }
+    expression_tokens.push_back(var);
+    pos = close + 1;
+  }
+  if(!literal.empty())
+    expression_tokens.push_back(get_literal_token(literal));
+  expression_begin.push_back(expression_tokens.size());
+  return expression_begin.size() - 2;
+}
 
-    if((pre_post[i].pre != -2) && (pre_post[i].pre != -3) && (pre_post[i].pre != -4) && (pre_post[i].pre != -5) && (pre_post[i].pre != -6))
-    	outfile << pre_post[i].var->get_level() << " " << pre_post[i].pre << " "
-	    	<< pre_post[i].post << endl;
+void OperatorArena::write_cost_expression(ostream &out, int expression,
+					  const vector<Variable *> &variables) const {
+  for(int i = expression_begin[expression]; i < expression_begin[expression + 1]; i++) {
+    int token = expression_tokens[i];
+    if(token < 0)
+      out << expression_literals[-token - 1];
     else
-    {
-    	if (pre_post[i].have_runtime_cost_effect){
+      out << ":" << variables[token]->get_level() << ":";
+  }
+}
 
-    		string s_effect = pre_post[i].runtime_cost_effect;
-    		string s_eff_aux = s_effect;
-    		while(s_effect.find("!") != string::npos){
-    			string var = "";
-    			int i_var;
-    			int var_level = 0;
-    			s_eff_aux = s_eff_aux.substr(s_eff_aux.find("!") + 1, s_eff_aux.length() - 1);
-    			var = s_eff_aux.substr(0, s_eff_aux.find("!"));
-    			s_eff_aux = s_eff_aux.substr(s_eff_aux.find("!") + 1, s_eff_aux.length() - 1);
-    			stringstream strm(var);
-    			strm >> i_var;
-    			strm.str(std::string());
-    			var_level = variables[i_var]->get_level();
-    			std::ostringstream strm_var;
-    			strm_var << var_level;
+string Operator::get_module_call() const {
+  if(cost_kind != MODULE_COST)
+    return "";
+  ostringstream call;
+  const vector<Variable *> no_variables;
+  arena->write_cost_expression(call, runtime_cost, no_variables);
+  return call.str();
+}
 
-    			string from = "!" + var + "!";
-    			string to = ":" + strm_var.str() + ":";
-    		    size_t start_pos = 0;
-    		    while((start_pos = s_effect.find(from, start_pos)) != std::string::npos) {
-    		    	s_effect.replace(start_pos, from.length(), to);
-    		        start_pos += to.length(); // Handles case where 'to' is a substring of 'from'
-    		    }
-    		}
+void Operator::write_effect(ostream &outfile, int effect,
+			    const vector<Variable *> &variables) const {
+  PrePost pre_post(arena, effect);
+  assert(pre_post.var->get_level() != -1);
+  if(pre_post.is_conditional_effect) {
+    outfile << pre_post.effect_conds.size() << endl;
+    for(int j = 0; j < pre_post.effect_conds.size(); j++)
+      outfile << pre_post.effect_conds[j].var->get_level() << " " <<
+	pre_post.effect_conds[j].cond << endl;
+  } else {
+    outfile << "0" << endl;
+  }
 
-    		outfile << pre_post[i].var->get_level() << " " << pre_post[i].pre << " "
-    		    	<< pre_post[i].post << " " << s_effect << endl;
-    	}
-    	else
-    		outfile << pre_post[i].var->get_level() << " " << pre_post[i].pre << " "
-    		    	<< pre_post[i].post << " " << pre_post[i].f_cost << endl;
-    }
+  outfile << pre_post.var->get_level() << " " << pre_post.pre << " "
+	  << pre_post.post;
+  int numeric = arena->effect_numeric[effect];
+  if(numeric != -1) {
+    const OperatorArena::NumericEffect &num_eff = arena->numeric_effects[numeric];
+    outfile << " ";
+    if(num_eff.expression != -1)
+      arena->write_cost_expression(outfile, num_eff.expression, variables);
+    else
+      outfile << num_eff.f_cost;
   }
+  outfile << endl;
+}
 
-  outfile << pre_block.size() << endl;
-  for(int i = 0; i < pre_block.size(); i++) {
-	  assert(pre_block[i].var->get_level() != -1);
-	  if(pre_block[i].is_conditional_effect) {
-	    outfile << pre_block[i].effect_conds.size() << endl;
-	    for(int j = 0; j < pre_block[i].effect_conds.size(); j++)
-	    	outfile << pre_block[i].effect_conds[j].var->get_level() << " " <<
-			  pre_post[i].effect_conds[j].cond << endl;
-	  } else {
-	    outfile << "0" << endl;
-	  }
+void Operator::generate_cpp_input(ostream &outfile, const vector<Variable *> &variables) const {
+  outfile << "begin_operator" << endl;
+  outfile << get_name() << endl;
 
-	  outfile << pre_block[i].var->get_level() << " " << pre_block[i].pre << " "
-	  	    	<< pre_block[i].post << endl;
+  outfile << prevail_end - prevail_begin << endl;
+  for(int i = prevail_begin; i < prevail_end; i++) {
+    Variable *var = arena->prevail_vars[i];
+    assert(var->get_level() != -1);
+    if(var->get_level() != -1)
+      outfile << var->get_level() << " "<< arena->prevail_vals[i] << endl;
   }
 
+  // Propositional and numeric effects are written in input order.
+  outfile << block_begin - effect_begin << endl;
+  int prop = effect_begin, num = numeric_begin;
+  for(int pos = 0; prop < numeric_begin || num < block_begin; pos++) {
+    if(num < block_begin &&
+       arena->numeric_effects[arena->effect_numeric[num]].position == pos)
+      write_effect(outfile, num++, variables);
+    else
+      write_effect(outfile, prop++, variables);
+  }
+
+  outfile << effect_end - block_begin << endl;
+  for(int i = block_begin; i < effect_end; i++)
+    write_effect(outfile, i, variables);
+
   outfile << cost << endl;
-  if(have_runtime_cost)
+  if(cost_kind == RUNTIME_COST)
   {
 	  outfile << "runtime" << endl;
-	  string s_effect = runtime_cost;
-	  string s_eff_aux = s_effect;
-	  while(s_effect.find("!") != string::npos){
-	  		string var = "";
-	   		int i_var;
-	   		int var_level = 0;
-	  		s_eff_aux = s_eff_aux.substr(s_eff_aux.find("!") + 1, s_eff_aux.length() - 1);
-	   		var = s_eff_aux.substr(0, s_eff_aux.find("!"));
-	   		s_eff_aux = s_eff_aux.substr(s_eff_aux.find("!") + 1, s_eff_aux.length() - 1);
-	   		stringstream strm(var);
-	   		strm >> i_var;
-	   		strm.str(std::string());
-	   		var_level = variables[i_var]->get_level();
-	   		std::ostringstream strm_var;
-	   		strm_var << var_level;
-	   		string from = "!" + var + "!";
-	   		string to = ":" + strm_var.str() + ":";
-      	    size_t start_pos = 0;
-  		    while((start_pos = s_effect.find(from, start_pos)) != std::string::npos) {
-      		    	s_effect.replace(start_pos, from.length(), to);
-      		        start_pos += to.length(); // Handles case where 'to' is a substring of 'from'
-      		}
-      }
-	  outfile << s_effect << endl;
-  }else if (have_module_cost){
+	  arena->write_cost_expression(outfile, runtime_cost, variables);
+	  outfile << endl;
+  }else if (cost_kind == MODULE_COST){
 	  outfile << "modulefunc" << endl;
-	  outfile << this->runtime_cost << endl;
+	  arena->write_cost_expression(outfile, runtime_cost, variables);
+	  outfile << endl;
   }
   else {
 	  outfile << "no-run" << endl;
@@ -273,3 +438,55 @@ void Operator::generate_cpp_input(ofstream &outfile, vector<Variable *> variable
   }
   outfile << "end_operator" << endl;
 }
+
+// Locality key of an operator, see renumber_operators.
+struct OperatorLocality {
+  int primary_level;
+  vector<pair<int, int> > preconditions;
+  int index;
+  bool operator<(const OperatorLocality &other) const {
+    if(primary_level != other.primary_level)
+      return primary_level < other.primary_level;
+    if(preconditions != other.preconditions)
+      return preconditions < other.preconditions;
+    return index < other.index;
+  }
+};
+
+void renumber_operators(vector<Operator> &operators) {
+  vector<OperatorLocality> keys(operators.size());
+  for(int i = 0; i < operators.size(); i++) {
+    const Operator &op = operators[i];
+    OperatorLocality &key = keys[i];
+    key.index = i;
+    key.primary_level = -1;
+    Operator::PrePostRange effects = op.get_pre_post();
+    for(int j = 0; j < effects.size(); j++) {
+      int level = effects[j].var->get_level();
+      if(level != -1 && (key.primary_level == -1 || level < key.primary_level))
+	key.primary_level = level;
+      if(effects[j].pre >= 0)
+	key.preconditions.push_back(make_pair(level, effects[j].pre));
+    }
+    Operator::PrevailRange prevail = op.get_prevail();
+    for(int j = 0; j < prevail.size(); j++)
+      key.preconditions.push_back(make_pair(prevail[j].var->get_level(),
+					    prevail[j].prev));
+    sort(key.preconditions.begin(), key.preconditions.end());
+  }
+  sort(keys.begin(), keys.end());
+  vector<Operator> renumbered;
+  renumbered.reserve(operators.size());
+  for(int i = 0; i < keys.size(); i++)
+    renumbered.push_back(operators[keys[i].index]);
+  operators.swap(renumbered);
+}
+
+void generate_operator_permutation(ostream &outfile,
+				   const vector<Operator> &operators) {
+  outfile << "begin_operator_permutation" << endl;
+  outfile << operators.size() << endl;
+  for(int i = 0; i < operators.size(); i++)
+    outfile << operators[i].get_input_index() << endl;
+  outfile << "end_operator_permutation" << endl;
+}
@@ -26,12 +26,86 @@
 
 #include <iostream>
 #include <fstream>
+#include <map>
 #include <string>
 #include <vector>
 using namespace std;
 
 class Variable;
 
+// Special values of the precondition (pre) of an effect.
+const int PRE_ANY = -1;        // the effect applies whatever the old value
+const int PRE_NUMERIC_MIN = -6; // -6 .. -2: numeric effects with a cost
+const int PRE_NUMERIC_MAX = -2;
+const int PRE_BLOCK_MIN = -8;   // -8, -7: blocking effects (pre_block)
+const int PRE_BLOCK_MAX = -7;
+
+inline bool is_numeric_pre(int pre) {
+  return pre >= PRE_NUMERIC_MIN && pre <= PRE_NUMERIC_MAX;
+}
+inline bool is_blocking_pre(int pre) {
+  return pre >= PRE_BLOCK_MIN && pre <= PRE_BLOCK_MAX;
+}
+
+/*
+  Flat storage shared by all operators of a task. Each operator refers to
+  ranges of these arrays, so reading and stripping operators never copies
+  per-operator vectors or strings. Effects are classified when they are
+  read: an operator's propositional effects come first, then its numeric
+  effects, then its blocking (pre_block) effects. The conditions of effect
+  i are [effect_cond_begin[i], effect_cond_begin[i + 1]).
+
+  Fields only numeric effects have (the cost value or expression) live in
+  a side table. Cost expressions are split into tokens when they are read:
+  a token t >= 0 is a reference "!t!" to variable t, which is written as
+  ":<level>:", and a token t < 0 is the literal text expression_literals[-t - 1].
+*/
+struct OperatorArena {
+  struct NumericEffect {
+    float f_cost;
+    int expression; // cost expression, or -1
+    // position among the operator's pre_post effects in the input,
+    // which is also the position they are written at
+    int position;
+    NumericEffect(float f_c, int expr, int pos)
+      : f_cost(f_c), expression(expr), position(pos) {}
+  };
+
+  vector<char> names;
+
+  vector<Variable *> prevail_vars;
+  vector<int> prevail_vals;
+
+  vector<Variable *> effect_vars;
+  vector<int> effect_pres;
+  vector<int> effect_posts;
+  vector<int> effect_numeric;  // index into numeric_effects, or -1
+  vector<int> effect_cond_begin;
+
+  vector<Variable *> effect_cond_vars;
+  vector<int> effect_cond_vals;
+
+  vector<NumericEffect> numeric_effects;
+
+  // expression i is [expression_begin[i], expression_begin[i + 1])
+  vector<int> expression_tokens;
+  vector<int> expression_begin;
+  vector<string> expression_literals;
+  map<string, int> literal_tokens;
+
+  OperatorArena() {
+    effect_cond_begin.push_back(0);
+    expression_begin.push_back(0);
+  }
+  void add_effect(Variable *var, int pre, int post, int numeric,
+		  const vector<pair<Variable *, int> > &conds);
+  int get_literal_token(const string &literal);
+  int add_cost_expression(const string &text, int num_variables);
+  // Writes the expression with variable references replaced by levels.
+  void write_cost_expression(ostream &out, int expression,
+			     const vector<Variable *> &variables) const;
+};
+
 class Operator {
 public:
   struct Prevail {
@@ -44,59 +118,135 @@ public:
     int cond;
     EffCond(Variable *v, int c) : var(v), cond(c) {}
   };
+  class PrevailRange {
+    const OperatorArena *arena;
+    int first, last;
+  public:
+    PrevailRange(const OperatorArena *a, int f, int l) : arena(a), first(f), last(l) {}
+    int size() const {return last - first;}
+    Prevail operator[](int i) const {
+      return Prevail(arena->prevail_vars[first + i], arena->prevail_vals[first + i]);
+    }
+  };
+  class EffCondRange {
+    const OperatorArena *arena;
+    int first, last;
+  public:
+    EffCondRange(const OperatorArena *a, int f, int l) : arena(a), first(f), last(l) {}
+    int size() const {return last - first;}
+    bool empty() const {return first == last;}
+    EffCond operator[](int i) const {
+      return EffCond(arena->effect_cond_vars[first + i], arena->effect_cond_vals[first + i]);
+    }
+  };
+  // View of one effect in the arena.
   struct PrePost {
+    int index; // position in the arena
     Variable *var;
     int pre, post;
-    float f_cost;
-    bool have_runtime_cost_effect;
-    string runtime_cost_effect;
     bool is_conditional_effect;
-    vector<EffCond> effect_conds;
-    PrePost(Variable *v, int pr, int po, float f_c) : var(v), pre(pr), post(po), f_cost(f_c){
-      is_conditional_effect = false;
-      have_runtime_cost_effect = false;
-      runtime_cost_effect = "";}
-
-    PrePost(Variable *v, int pr, int po, float f_c, std::string& run_cost) : var(v), pre(pr), post(po),
-    		f_cost(f_c), runtime_cost_effect(run_cost){
-      is_conditional_effect = false;
-      have_runtime_cost_effect = true;}
-
-    PrePost(Variable *v, vector<EffCond> ecs, int pr, int po, float f_c) : var(v), pre(pr),
-	 post(po), f_cost(f_c), effect_conds(ecs) {
-    	is_conditional_effect = true;
-    	have_runtime_cost_effect = false;
-    	runtime_cost_effect = "";}
-
-    PrePost(Variable *v, vector<EffCond> ecs, int pr, int po, float f_c, std::string& run_cost) : var(v), pre(pr),
-	 post(po), f_cost(f_c), runtime_cost_effect(run_cost), effect_conds(ecs){
-    	is_conditional_effect = true;
-    	have_runtime_cost_effect = true;}
+    EffCondRange effect_conds;
+    PrePost(const OperatorArena *arena, int i)
+      : index(i), var(arena->effect_vars[i]), pre(arena->effect_pres[i]),
+	post(arena->effect_posts[i]),
+	effect_conds(arena, arena->effect_cond_begin[i], arena->effect_cond_begin[i + 1]) {
+      is_conditional_effect = !effect_conds.empty();
+    }
+  };
+  class PrePostRange {
+    const OperatorArena *arena;
+    int first, last;
+  public:
+    PrePostRange(const OperatorArena *a, int f, int l) : arena(a), first(f), last(l) {}
+    int size() const {return last - first;}
+    bool empty() const {return first == last;}
+    PrePost operator[](int i) const {return PrePost(arena, first + i);}
   };
+  enum CostKind {NO_RUNTIME_COST, RUNTIME_COST, MODULE_COST};
   
 private:
-  string name;
-  vector<Prevail> prevail;      // var, val
-  vector<PrePost> pre_post; // var, old-val, new-val
-  vector<PrePost> pre_block;
+  OperatorArena *arena;
+  int input_index;                // position in the input
+  int name_begin, name_end;
+  int prevail_begin, prevail_end; // var, val
+  int effect_begin;               // pre_post: var, old-val, new-val
+  int numeric_begin;              // numeric part of pre_post
+  int block_begin, effect_end;    // pre_block
+  bool conditional_effects;
   float cost;
-  bool have_runtime_cost;
-  bool have_module_cost;
-  string runtime_cost;
+  CostKind cost_kind;
+  int runtime_cost;               // cost expression, or -1
+
+  void write_effect(ostream &outfile, int effect,
+		    const vector<Variable *> &variables) const;
 public:
-  Operator(istream &in, const vector<Variable *> &variables);
+  Operator(istream &in, const vector<Variable *> &variables, OperatorArena &arena,
+	   int input_index);
 
-  void strip_unimportant_effects();
   bool is_redundant() const;
 
   void dump() const;
-  void generate_cpp_input(ofstream &outfile, vector<Variable *> variables) const;
-  string get_name() const {return name;}
-  const vector<Prevail> &get_prevail() const {return prevail;}
-  const vector<PrePost> &get_pre_post() const {return pre_post;}
-  const vector<PrePost> &get_pre_block() const {return pre_block;}
+  void generate_cpp_input(ostream &outfile, const vector<Variable *> &variables) const;
+  string get_name() const;
+  int get_input_index() const {return input_index;}
+  PrevailRange get_prevail() const {
+    return PrevailRange(arena, prevail_begin, prevail_end);
+  }
+  // Propositional and numeric effects; the numeric ones come last.
+  PrePostRange get_pre_post() const {
+    return PrePostRange(arena, effect_begin, block_begin);
+  }
+  PrePostRange get_propositional_effects() const {
+    return PrePostRange(arena, effect_begin, numeric_begin);
+  }
+  PrePostRange get_numeric_effects() const {
+    return PrePostRange(arena, numeric_begin, block_begin);
+  }
+  PrePostRange get_pre_block() const {
+    return PrePostRange(arena, block_begin, effect_end);
+  }
+  bool has_numeric_effects() const {return numeric_begin != block_begin;}
+  bool has_blocking_effects() const {return block_begin != effect_end;}
+  bool has_conditional_effects() const {return conditional_effects;}
+  bool has_runtime_cost() const {return cost_kind == RUNTIME_COST;}
+  bool has_module_cost() const {return cost_kind == MODULE_COST;}
+  float get_cost() const {return cost;}
+  CostKind get_cost_kind() const {return cost_kind;}
+  // Runtime cost expression or module call, or -1.
+  int get_cost_expression() const {return runtime_cost;}
+  // The modulefunc reference as read, or "" if there is none.
+  string get_module_call() const;
+  // Cost expression of the runtime cost, or -1.
+  int get_runtime_cost_expression() const {
+    return cost_kind == RUNTIME_COST ? runtime_cost : -1;
+  }
+  // Cost of the i-th numeric effect.
+  const OperatorArena::NumericEffect &get_numeric_effect(int i) const {
+    return arena->numeric_effects[arena->effect_numeric[numeric_begin + i]];
+  }
+  const OperatorArena &get_arena() const {return *arena;}
+
+  friend void strip_operators(vector<Operator> &operators);
 };
 
+// Removes the effects on unimportant variables, then the operators left
+// without effects, compacting the arena.
 extern void strip_operators(vector<Operator> &operators);
 
+// If set, the stripped operators are renumbered for locality and the
+// input index of every operator is written after the main output:
+//   begin_operator_permutation
+//   <number of operators>
+//   <input index>      (one line per operator in output order)
+//   end_operator_permutation
+extern bool g_renumber_operators;
+// Sorts the operators by the lowest level of a variable they change, then
+// by their preconditions as (level, value) pairs, so that operators with
+// the same preconditions get neighbouring numbers in the successor
+// generator and DTGs. Only the handles move; it must run after
+// strip_operators, which relies on the arena order.
+extern void renumber_operators(vector<Operator> &operators);
+extern void generate_operator_permutation(ostream &outfile,
+					  const vector<Operator> &operators);
+
 #endif
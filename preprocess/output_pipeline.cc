@@ -0,0 +1,130 @@
+/*********************************************************************
+ * This file is part of LAMA.
+ *
+ * LAMA is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the license, or (at your option) any later version.
+ *
+ * LAMA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ *********************************************************************/
+
+#include "output_pipeline.h"
+#include "helper_functions.h"
+#include "successor_generator.h"
+#include "domain_transition_graph.h"
+#include "causal_graph.h"
+#include "module_index.h"
+
+#include <cassert>
+#include <iostream>
+using namespace std;
+
+OutputPipeline::OutputPipeline(ofstream &the_outfile,
+			       const vector<Variable *> &the_ordered_vars,
+			       const string &the_metric,
+			       const State &the_initial_state,
+			       const vector<pair<Variable*, int> > &the_goals,
+			       const vector<pair<pair<Variable*, int>, vector<pair<pair<Variable*, int>, double> > > > &the_timed_goals,
+			       const vector<pair<string, vector<pair<string, vector<pair<string, string> > > > > > &the_modules,
+			       const ModuleIndex &the_module_index,
+			       const vector<Operator> &the_operators,
+			       const vector<Axiom> &the_axioms,
+			       const string &the_name,
+			       const vector<Variable *> &the_shared_vars,
+			       const vector<int> &the_shared_vars_number,
+			       const vector<Variable *> &the_variables)
+  : outfile(the_outfile), ordered_vars(the_ordered_vars), metric(the_metric),
+    initial_state(the_initial_state), goals(the_goals),
+    timed_goals(the_timed_goals), modules(the_modules),
+    module_index(the_module_index),
+    operators(the_operators), axioms(the_axioms), name(the_name),
+    shared_vars(the_shared_vars), shared_vars_number(the_shared_vars_number),
+    variables(the_variables), writer_running(false) {
+}
+
+OutputPipeline::~OutputPipeline() {
+  wait_for_prefix();
+}
+
+void *OutputPipeline::run_writer(void *pipeline) {
+  static_cast<OutputPipeline *>(pipeline)->write_prefix();
+  return 0;
+}
+
+void OutputPipeline::write_prefix() {
+  // The poly time flag is the first character after the name line.
+  string name_line = (name == "") ? "gen" : name;
+  poly_time_pos = outfile.tellp() + streamoff(name_line.size() + 1);
+  generate_cpp_input_prefix(outfile, false, ordered_vars, metric,
+			    initial_state, goals, timed_goals, modules,
+			    module_index, operators, axioms, name, shared_vars,
+			    shared_vars_number, variables);
+}
+
+void OutputPipeline::start(bool in_background) {
+  assert(!writer_running);
+  if(!in_background) {
+    write_prefix();
+  } else if(pthread_create(&writer, 0, &OutputPipeline::run_writer, this) == 0) {
+    writer_running = true;
+  } else {
+    cout << "Could not start output writer thread, "
+	 << "writing output sequentially." << endl;
+    write_prefix();
+  }
+}
+
+void OutputPipeline::wait_for_prefix() {
+  if(writer_running) {
+    pthread_join(writer, 0);
+    writer_running = false;
+  }
+}
+
+void OutputPipeline::patch_poly_time_flag(bool solveable_in_poly_time) {
+  if(solveable_in_poly_time) {
+    streampos end_pos = outfile.tellp();
+    outfile.seekp(poly_time_pos);
+    outfile << solveable_in_poly_time;
+    outfile.seekp(end_pos);
+  }
+}
+
+void OutputPipeline::finish(bool solveable_in_poly_time,
+			    const SuccessorGenerator &sg,
+			    const vector<DomainTransitionGraph> &transition_graphs,
+			    const CausalGraph &cg) {
+  wait_for_prefix();
+  generate_cpp_input_suffix(outfile, ordered_vars, sg, transition_graphs, cg);
+  patch_poly_time_flag(solveable_in_poly_time);
+}
+
+bool OutputPipeline::finish_streaming(bool check_connectivity,
+				      ConditionPool &conditions,
+				      const SuccessorGenerator &sg,
+				      const CausalGraph &cg,
+				      vector<DTGDistanceTable> *distances) {
+  wait_for_prefix();
+  outfile << "begin_SG" << endl;
+  sg.generate_cpp_input(outfile);
+  outfile << "end_SG" << endl;
+
+  bool solveable_in_poly_time = generate_DTGs_streaming(
+    outfile, ordered_vars, operators, axioms, conditions, check_connectivity,
+    distances);
+
+  outfile << "begin_CG" << endl;
+  cg.generate_cpp_input(outfile, ordered_vars);
+  outfile << "end_CG" << endl;
+
+  patch_poly_time_flag(solveable_in_poly_time);
+  return solveable_in_poly_time;
+}
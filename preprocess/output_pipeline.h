@@ -0,0 +1,109 @@
+/*********************************************************************
+ * This file is part of LAMA.
+ *
+ * LAMA is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the license, or (at your option) any later version.
+ *
+ * LAMA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ *********************************************************************/
+
+#ifndef OUTPUT_PIPELINE_H
+#define OUTPUT_PIPELINE_H
+
+/*
+  Pipelined output writing.
+
+  Everything up to and including the axioms is final as soon as the
+  variable ordering is known and the operators and axioms are stripped.
+  OutputPipeline writes that prefix from a separate thread while the main
+  thread builds the DTGs and the successor generator, and then appends
+  the remaining sections in finish().
+
+  In streaming mode (finish_streaming()), the DTGs are not kept in memory
+  at all: each one is built, written and freed in turn.
+
+  The only prefix value that is not known in advance is the "solveable in
+  poly time" flag in the second line. The writer emits a "0" placeholder
+  and finish() patches it in place once the DTGs have been checked.
+*/
+
+#include <pthread.h>
+#include <fstream>
+#include <string>
+#include <vector>
+using namespace std;
+
+class Variable;
+class State;
+class Operator;
+class Axiom;
+class SuccessorGenerator;
+class DomainTransitionGraph;
+struct DTGDistanceTable;
+class CausalGraph;
+class ConditionPool;
+class ModuleIndex;
+
+class OutputPipeline {
+  ofstream &outfile;
+  const vector<Variable *> &ordered_vars;
+  const string &metric;
+  const State &initial_state;
+  const vector<pair<Variable*, int> > &goals;
+  const vector<pair<pair<Variable*, int>, vector<pair<pair<Variable*, int>, double> > > > &timed_goals;
+  const vector<pair<string, vector<pair<string, vector<pair<string, string> > > > > > &modules;
+  const ModuleIndex &module_index;
+  const vector<Operator> &operators;
+  const vector<Axiom> &axioms;
+  const string &name;
+  const vector<Variable *> &shared_vars;
+  const vector<int> &shared_vars_number;
+  const vector<Variable *> &variables;
+
+  streampos poly_time_pos;
+  pthread_t writer;
+  bool writer_running;
+
+  static void *run_writer(void *pipeline);
+  void write_prefix();
+  void wait_for_prefix();
+  void patch_poly_time_flag(bool solveable_in_poly_time);
+  OutputPipeline(const OutputPipeline &copy);
+public:
+  OutputPipeline(ofstream &outfile,
+		 const vector<Variable *> &ordered_vars,
+		 const string &metric,
+		 const State &initial_state,
+		 const vector<pair<Variable*, int> > &goals,
+		 const vector<pair<pair<Variable*, int>, vector<pair<pair<Variable*, int>, double> > > > &timed_goals,
+		 const vector<pair<string, vector<pair<string, vector<pair<string, string> > > > > > &modules,
+		 const ModuleIndex &module_index,
+		 const vector<Operator> &operators,
+		 const vector<Axiom> &axioms,
+		 const string &name,
+		 const vector<Variable *> &shared_vars,
+		 const vector<int> &shared_vars_number,
+		 const vector<Variable *> &variables);
+  ~OutputPipeline();
+  void start(bool in_background);
+  void finish(bool solveable_in_poly_time,
+	      const SuccessorGenerator &sg,
+	      const vector<DomainTransitionGraph> &transition_graphs,
+	      const CausalGraph &cg);
+  bool finish_streaming(bool check_connectivity,
+			ConditionPool &conditions,
+			const SuccessorGenerator &sg,
+			const CausalGraph &cg,
+			vector<DTGDistanceTable> *distances);
+};
+
+#endif
@@ -0,0 +1,78 @@
+/*********************************************************************
+ * This file is part of LAMA.
+ *
+ * LAMA is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the license, or (at your option) any later version.
+ *
+ * LAMA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ *********************************************************************/
+
+#include "parallel.h"
+
+#include <pthread.h>
+#include <vector>
+using namespace std;
+
+int g_num_threads = 1;
+
+struct ParallelLoop {
+  int next;
+  int end;
+  ParallelBody body;
+  void *context;
+  pthread_mutex_t lock;
+};
+
+static void *run_parallel_worker(void *data) {
+  ParallelLoop *loop = static_cast<ParallelLoop *>(data);
+  while(true) {
+    pthread_mutex_lock(&loop->lock);
+    int index = loop->next++;
+    pthread_mutex_unlock(&loop->lock);
+    if(index >= loop->end)
+      break;
+    loop->body(index, loop->context);
+  }
+  return 0;
+}
+
+void parallel_for(int begin, int end, ParallelBody body, void *context) {
+  int num_threads = g_num_threads;
+  if(num_threads > end - begin)
+    num_threads = end - begin;
+  if(num_threads <= 1) {
+    for(int i = begin; i < end; i++)
+      body(i, context);
+    return;
+  }
+
+  ParallelLoop loop;
+  loop.next = begin;
+  loop.end = end;
+  loop.body = body;
+  loop.context = context;
+  pthread_mutex_init(&loop.lock, 0);
+
+  // The calling thread is one of the workers. If a thread cannot be
+  // started, the remaining ones simply take over its share.
+  vector<pthread_t> workers;
+  for(int i = 1; i < num_threads; i++) {
+    pthread_t worker;
+    if(pthread_create(&worker, 0, &run_parallel_worker, &loop) == 0)
+      workers.push_back(worker);
+  }
+  run_parallel_worker(&loop);
+  for(int i = 0; i < workers.size(); i++)
+    pthread_join(workers[i], 0);
+
+  pthread_mutex_destroy(&loop.lock);
+}
@@ -0,0 +1,38 @@
+/*********************************************************************
+ * This file is part of LAMA.
+ *
+ * LAMA is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the license, or (at your option) any later version.
+ *
+ * LAMA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ *********************************************************************/
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+/*
+  Minimal pthread-based parallel loop.
+
+  parallel_for(begin, end, body, context) calls body(i, context) for every
+  i in [begin, end), using up to g_num_threads threads (including the
+  calling thread). Indices are handed out one at a time, so expensive and
+  cheap iterations balance out. The body must only write to data owned by
+  its own index. With g_num_threads == 1 this is a plain loop.
+*/
+
+extern int g_num_threads;
+
+typedef void (*ParallelBody)(int index, void *context);
+
+extern void parallel_for(int begin, int end, ParallelBody body, void *context);
+
+#endif
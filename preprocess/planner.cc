@@ -37,6 +37,23 @@
 #include "operator.h"
 #include "axiom.h"
 #include "variable.h"
+#include "output_pipeline.h"
+#include "fact_index.h"
+#include "condition_pool.h"
+#include "parallel.h"
+#include "cost_bytecode.h"
+#include "module_index.h"
+#include "timed_goals.h"
+#include "dedup.h"
+#include "h2_mutexes.h"
+#include "numeric_bounds.h"
+#include "fact_operator_index.h"
+#include "landmarks.h"
+#include "axiom_layers.h"
+#include "state_packing.h"
+#include "precondition_matrix.h"
+#include <algorithm>
+#include <cstdlib>
 #include <iostream>
 using namespace std;
 
@@ -48,17 +65,68 @@ int main(int argc, const char **argv) {
   vector<pair<Variable *, int> > goals;
   vector<pair<pair<Variable*, int>, vector<pair<pair<Variable*, int>, double> > > > timed_goals;
   vector<Operator> operators;
+  OperatorArena operator_arena;
   vector<Axiom> axioms;
   vector<DomainTransitionGraph> transition_graphs;
+  vector<DTGDistanceTable> dtg_distances;
   string name = "";
   vector<Variable *> shared_vars;
   vector<pair<string, vector<pair<string, vector<pair<string, string> > > > > > modules;
   vector<int> shared_vars_number;
+  bool pipelined_output = false;
+  bool stream_dtgs = false;
 
   if(argc != 1) {
       cout << "*** do not perform relevance analysis ***" << endl;
       g_do_not_prune_variables = true;
   }
+  for(int i = 2; i < argc; i++) {
+    string option = argv[i];
+    if(option == "--pipeline")
+      pipelined_output = true;
+    else if(option == "--stream-dtgs")
+      stream_dtgs = true;
+    else if(option == "--compact-wildcards")
+      g_compact_wildcard_transitions = true;
+    else if(option == "--merge-dtg-transitions")
+      g_merge_dtg_transitions = true;
+    else if(option == "--cheapest-dtg-transitions")
+      g_cheapest_dtg_transitions = true;
+    else if(option == "--threads" && i + 1 < argc)
+      g_num_threads = max(1, atoi(argv[++i]));
+    else if(option == "--cost-bytecode")
+      g_cost_bytecode = true;
+    else if(option == "--resolve-modules")
+      g_resolve_modules = true;
+    else if(option == "--timed-goal-index")
+      g_timed_goal_index = true;
+    else if(option == "--dedup")
+      g_dedup = true;
+    else if(option == "--prune-dominated")
+      g_prune_dominated = true;
+    else if(option == "--h2-mutexes")
+      g_h2_mutexes = true;
+    else if(option == "--h2-time-limit" && i + 1 < argc)
+      g_h2_time_limit = atof(argv[++i]);
+    else if(option == "--numeric-bounds")
+      g_numeric_bounds = true;
+    else if(option == "--fact-operator-index")
+      g_fact_operator_index = true;
+    else if(option == "--landmarks")
+      g_landmarks = true;
+    else if(option == "--axiom-layers")
+      g_axiom_layers = true;
+    else if(option == "--state-packing")
+      g_state_packing = true;
+    else if(option == "--renumber-operators")
+      g_renumber_operators = true;
+    else if(option == "--precondition-matrix")
+      g_precondition_matrix = true;
+    else if(option == "--dtg-distances")
+      g_dtg_distances = true;
+    else
+      cout << "Ignoring unknown option '" << option << "'." << endl;
+  }
 
   std::fstream fs;
   fs.open (argv[1], std::fstream::in);
@@ -81,9 +149,11 @@ int main(int argc, const char **argv) {
   }
 
   read_preprocessed_problem_description
-    (fs, metric, internal_variables, variables, initial_state, goals, timed_goals, operators, axioms, shared_vars, shared_vars_number, modules);
+    (fs, metric, internal_variables, variables, initial_state, goals, timed_goals, operators, operator_arena, axioms, shared_vars, shared_vars_number, modules);
   //dump_preprocessed_problem_description
   //  (variables, initial_state, goals, operators, axioms);
+  FactIndex facts(variables);
+  ConditionPool conditions(facts);
   
   cout << "Building causal graph..." << endl;
   CausalGraph causal_graph(variables, operators, axioms, goals);
@@ -94,22 +164,125 @@ int main(int argc, const char **argv) {
   // operators and axioms without effects.
   strip_operators(operators);
   strip_axioms(axioms);
+  if(g_dedup) {
+    vector<pair<string, string> > removed_operators;
+    dedup_operators(operators, removed_operators);
+    dedup_axioms(axioms);
+    write_removed_operators(get_output_file_name(name, prefix) + "_dedup",
+			    removed_operators);
+  }
+  if(g_prune_dominated) {
+    vector<pair<string, string> > dominated_operators;
+    prune_dominated_operators(operators, facts, dominated_operators);
+    write_removed_operators(get_output_file_name(name, prefix) + "_dominated",
+			    dominated_operators);
+  }
+  H2Mutexes mutexes(facts);
+  if(g_h2_mutexes) {
+    cout << "Computing h^2 mutexes..." << endl;
+    if(mutexes.compute(variables, operators, initial_state, shared_vars,
+		       timed_goals, g_h2_time_limit))
+      mutexes.prune_operators(operators);
+  }
+  // Everything that refers to operators by index is built from here on.
+  if(g_renumber_operators)
+    renumber_operators(operators);
+  NumericBounds numeric_bounds;
+  if(g_numeric_bounds) {
+    cout << "Computing numeric bounds..." << endl;
+    numeric_bounds.compute(variables, operators, initial_state, shared_vars);
+  }
+  LandmarkGraph landmarks(facts);
+  if(g_landmarks) {
+    cout << "Computing landmarks..." << endl;
+    landmarks.compute(variables, operators, initial_state, goals, shared_vars,
+		      timed_goals);
+  }
+
+  // Operator indices in the module index refer to the stripped operators.
+  ModuleIndex module_index;
+  if(g_resolve_modules) {
+    cout << "Resolving module functions..." << endl;
+    if(!module_index.resolve(modules, operators, variables))
+      exit(1);
+  }
+  // Rule numbers refer to the stripped axioms.
+  AxiomLayers axiom_layers;
+  if(g_axiom_layers) {
+    cout << "Checking axiom layers..." << endl;
+    if(!axiom_layers.check(axioms, initial_state))
+      exit(1);
+  }
+  StatePacking state_packing;
+  if(g_state_packing) {
+    cout << "Computing state packing..." << endl;
+    state_packing.compute(variables, operators, initial_state);
+  }
+  PreconditionMatrix precondition_matrix;
+
+  // From here on the output prefix (up to the axioms) is final, so in
+  // pipelined mode it is written while the graphs are being built.
+  ofstream outfile;
+  OutputPipeline pipeline(outfile, ordering, metric, initial_state, goals,
+			  timed_goals, modules, module_index, operators, axioms,
+			  name, shared_vars, shared_vars_number, variables);
+  if(pipelined_output || stream_dtgs) {
+    if(pipelined_output)
+      cout << "Writing output prefix in the background..." << endl;
+    outfile.open(get_output_file_name(name, prefix).c_str(), ios::out);
+    pipeline.start(pipelined_output);
+  }
+
+  if(stream_dtgs) {
+    // Each DTG is written as soon as it is built, so the successor
+    // generator has to come first.
+    cout << "Building successor generator..." << endl;
+    SuccessorGenerator successor_generator(ordering, operators, conditions);
+    if(g_precondition_matrix)
+      precondition_matrix.compute(variables, operators, successor_generator);
+    cout << "Building and writing domain transition graphs..." << endl;
+    bool solveable_in_poly_time = pipeline.finish_streaming(
+      cg_acyclic, conditions, successor_generator, causal_graph,
+      g_dtg_distances ? &dtg_distances : 0);
+    outfile.close();
+    cout << "solveable in poly time " << solveable_in_poly_time << endl;
+    generate_optional_sections(get_output_file_name(name, prefix), variables,
+			       operators, mutexes, numeric_bounds, landmarks,
+			       axiom_layers, state_packing, precondition_matrix,
+			       dtg_distances);
+    cout << "done" << endl << endl;
+    return 0;
+  }
 
   cout << "Building domain transition graphs..." << endl;
-  build_DTGs(ordering, operators, axioms, transition_graphs);
+  build_DTGs(ordering, operators, axioms, conditions, transition_graphs,
+	     g_dtg_distances ? &dtg_distances : 0);
   //dump_DTGs(ordering, transition_graphs);
   bool solveable_in_poly_time = false;
   if(cg_acyclic)
     solveable_in_poly_time = are_DTGs_strongly_connected(transition_graphs);
   cout << "solveable in poly time " << solveable_in_poly_time << endl;
   cout << "Building successor generator..." << endl;
-  SuccessorGenerator successor_generator(ordering, operators);
+  SuccessorGenerator successor_generator(ordering, operators, conditions);
   // successor_generator.dump();
+  if(g_precondition_matrix)
+    precondition_matrix.compute(variables, operators, successor_generator);
 
   cout << "Writing output..." << endl;
-  generate_cpp_input(solveable_in_poly_time, ordering, metric, initial_state, 
-		     goals, timed_goals, modules, operators, axioms, successor_generator,
-		     transition_graphs, causal_graph, name, shared_vars, shared_vars_number,
-			 variables, prefix);
+  if(pipelined_output) {
+    pipeline.finish(solveable_in_poly_time, successor_generator,
+		    transition_graphs, causal_graph);
+    outfile.close();
+  } else {
+    generate_cpp_input(solveable_in_poly_time, ordering, metric, initial_state, 
+		       goals, timed_goals, modules, module_index, operators, axioms,
+		       successor_generator,
+		       transition_graphs, causal_graph, name, shared_vars, shared_vars_number,
+		       variables, prefix);
+  }
+  generate_optional_sections(get_output_file_name(name, prefix), variables,
+			     operators, mutexes, numeric_bounds, landmarks,
+			     axiom_layers, state_packing, precondition_matrix,
+			     dtg_distances);
   cout << "done" << endl << endl;
 }
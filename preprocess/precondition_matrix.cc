@@ -0,0 +1,122 @@
+/*********************************************************************
+ * This file is part of LAMA.
+ *
+ * LAMA is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the license, or (at your option) any later version.
+ *
+ * LAMA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ *********************************************************************/
+
+#include "precondition_matrix.h"
+#include "operator.h"
+#include "successor_generator.h"
+#include "variable.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+using namespace std;
+
+bool g_precondition_matrix = false;
+
+// Vector instructions handle this many 64-bit words at once.
+static const int WORDS_PER_VECTOR = 4;
+
+int PreconditionMatrix::padded_words(int bits) {
+  int words = (bits + 63) / 64;
+  return (words + WORDS_PER_VECTOR - 1) / WORDS_PER_VECTOR * WORDS_PER_VECTOR;
+}
+
+void PreconditionMatrix::set_bit(Half *bits, int bit) {
+  bits[bit / 32] |= Half(1) << (bit % 32);
+}
+
+void PreconditionMatrix::write_words(ostream &outfile, const vector<Half> &bits,
+				     int first_word, int words) {
+  for(int w = first_word; w < first_word + words; w++)
+    outfile << (w != first_word ? " " : "") << setw(8) << bits[2 * w + 1]
+	    << setw(8) << bits[2 * w];
+  outfile << endl;
+}
+
+void PreconditionMatrix::compute(const vector<Variable *> &variables,
+				 const vector<Operator> &operators,
+				 const SuccessorGenerator &sg) {
+  num_levels = 0;
+  for(int i = 0; i < variables.size(); i++)
+    num_levels = max(num_levels, variables[i]->get_level() + 1);
+  vector<int> range_of_level(num_levels, 0);
+  for(int i = 0; i < variables.size(); i++)
+    if(variables[i]->get_level() != -1)
+      range_of_level[variables[i]->get_level()] = variables[i]->get_range();
+  vector<int> first_fact(num_levels + 1, 0);
+  for(int level = 0; level < num_levels; level++)
+    first_fact[level + 1] = first_fact[level] + range_of_level[level];
+  num_operators = operators.size();
+  num_facts = first_fact[num_levels];
+  row_words = padded_words(num_facts);
+  mask_words = padded_words(num_levels);
+
+  rows.assign(num_operators * row_words * 2, 0);
+  masks.assign(num_operators * mask_words * 2, 0);
+  for(int i = 0; i < num_operators; i++) {
+    const Operator &op = operators[i];
+    Half *row = row_words ? &rows[i * row_words * 2] : 0;
+    Half *mask = mask_words ? &masks[i * mask_words * 2] : 0;
+    Operator::PrevailRange prevail = op.get_prevail();
+    for(int j = 0; j < prevail.size(); j++) {
+      int level = prevail[j].var->get_level();
+      if(level == -1)
+	continue;
+      set_bit(row, first_fact[level] + prevail[j].prev);
+      set_bit(mask, level);
+    }
+    Operator::PrePostRange ranges[2] = {op.get_pre_post(), op.get_pre_block()};
+    for(int r = 0; r < 2; r++)
+      for(int j = 0; j < ranges[r].size(); j++) {
+	Operator::PrePost eff = ranges[r][j];
+	int level = eff.var->get_level();
+	if(level == -1)
+	  continue;
+	if(eff.pre >= 0)
+	  set_bit(row, first_fact[level] + eff.pre);
+	set_bit(mask, level);
+      }
+  }
+
+  sg_visits = sg.expected_visits();
+  computed = true;
+  double matrix_words = double(num_operators) * row_words;
+  cout << "Successor generator: " << sg_visits << " expected visits per state; "
+       << "precondition matrix: " << matrix_words << " words per state ("
+       << matrix_words / WORDS_PER_VECTOR << " vector operations)." << endl;
+}
+
+void PreconditionMatrix::generate_cpp_input(ostream &outfile) const {
+  outfile << "begin_precondition_matrix" << endl;
+  outfile << num_facts << " " << row_words << endl;
+  outfile << num_levels << " " << mask_words << endl;
+  outfile << num_operators << endl;
+  ios::fmtflags old_flags = outfile.flags();
+  char old_fill = outfile.fill('0');
+  outfile << hex;
+  for(int i = 0; i < num_operators; i++) {
+    write_words(outfile, rows, i * row_words, row_words);
+    write_words(outfile, masks, i * mask_words, mask_words);
+  }
+  outfile.flags(old_flags);
+  outfile.fill(old_fill);
+  streamsize old_precision = outfile.precision(17);
+  outfile << sg_visits << " " << double(num_operators) * row_words << endl;
+  outfile.precision(old_precision);
+  outfile << "end_precondition_matrix" << endl;
+}
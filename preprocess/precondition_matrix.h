@@ -0,0 +1,87 @@
+/*********************************************************************
+ * This file is part of LAMA.
+ *
+ * LAMA is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the license, or (at your option) any later version.
+ *
+ * LAMA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ *********************************************************************/
+
+#ifndef PRECONDITION_MATRIX_H
+#define PRECONDITION_MATRIX_H
+
+/*
+  Precondition bit matrix, an alternative to the successor generator.
+
+  Facts are numbered by level as in fact_operator_index.h. Row i of the
+  matrix has a bit for every precondition (prevail condition or effect
+  precondition) of operator i, so operator i is applicable in a state
+  with fact bits s iff (s & row) == row. Each operator also has a mask
+  with a bit for every variable level it reads or changes. Rows and masks
+  are padded to a multiple of four 64-bit words, so that they can be
+  scanned with 256-bit vector instructions.
+
+  For comparison, the expected cost of a successor generator lookup
+  (nodes and operator entries visited, see
+  SuccessorGenerator::expected_visits()) and of a matrix scan (64-bit
+  words read) are reported and written with the matrix:
+
+    begin_precondition_matrix
+    <number of facts> <words per row>
+    <number of variables> <words per mask>
+    <number of operators>
+    <word> ...    (row of operator 0; bit b of word w is fact 64 * w + b)
+    <word> ...    (mask of operator 0)
+    ...
+    <successor generator visits> <matrix words>
+    end_precondition_matrix
+
+  Words are written as 16 hexadecimal digits.
+*/
+
+#include <fstream>
+#include <vector>
+using namespace std;
+
+class Operator;
+class SuccessorGenerator;
+class Variable;
+
+extern bool g_precondition_matrix;
+
+class PreconditionMatrix {
+  // Words are stored as two 32-bit halves, low half first.
+  typedef unsigned int Half;
+  int num_operators;
+  int num_facts, row_words;
+  int num_levels, mask_words;
+  vector<Half> rows;
+  vector<Half> masks;
+  double sg_visits;
+  bool computed;
+
+  static int padded_words(int bits);
+  static void set_bit(Half *bits, int bit);
+  static void write_words(ostream &outfile, const vector<Half> &bits,
+			  int first_word, int words);
+public:
+  PreconditionMatrix()
+    : num_operators(0), num_facts(0), row_words(0), num_levels(0), mask_words(0),
+      sg_visits(0), computed(false) {}
+  void compute(const vector<Variable *> &variables,
+	       const vector<Operator> &operators,
+	       const SuccessorGenerator &sg);
+  bool is_computed() const {return computed;}
+  void generate_cpp_input(ostream &outfile) const;
+};
+
+#endif
@@ -0,0 +1,86 @@
+/*********************************************************************
+ * This file is part of LAMA.
+ *
+ * LAMA is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the license, or (at your option) any later version.
+ *
+ * LAMA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ *********************************************************************/
+
+#include "preprocessed_task.h"
+#include "helper_functions.h"
+#include "successor_generator.h"
+#include "causal_graph.h"
+#include "fact_index.h"
+#include "condition_pool.h"
+
+#include <cassert>
+
+PreprocessedTask::PreprocessedTask()
+  : facts(0), conditions(0), causal_graph(0), successor_generator(0),
+    solveable_in_poly_time(false) {
+}
+
+PreprocessedTask::~PreprocessedTask() {
+  delete successor_generator;
+  delete causal_graph;
+  delete conditions;
+  delete facts;
+}
+
+void PreprocessedTask::read(istream &in) {
+  assert(!causal_graph);
+  in >> name;
+  if(name == "gen")
+    name = "";
+  read_preprocessed_problem_description
+    (in, metric, internal_variables, variables, initial_state, goals,
+     timed_goals, operators, operator_arena, axioms, shared_vars,
+     shared_vars_number, modules);
+}
+
+bool PreprocessedTask::preprocess() {
+  assert(!causal_graph);
+  facts = new FactIndex(variables);
+  conditions = new ConditionPool(*facts);
+  causal_graph = new CausalGraph(variables, operators, axioms, goals);
+  const vector<Variable *> &ordering = causal_graph->get_variable_ordering();
+
+  strip_operators(operators);
+  strip_axioms(axioms);
+  if(g_resolve_modules && !module_index.resolve(modules, operators, variables))
+    return false;
+
+  build_DTGs(ordering, operators, axioms, *conditions, transition_graphs, 0);
+  if(causal_graph->is_acyclic())
+    solveable_in_poly_time = are_DTGs_strongly_connected(transition_graphs);
+  successor_generator = new SuccessorGenerator(ordering, operators,
+					       *conditions);
+  return true;
+}
+
+const vector<Variable *> &PreprocessedTask::get_ordered_variables() const {
+  if(!causal_graph)
+    return variables;
+  return causal_graph->get_variable_ordering();
+}
+
+void PreprocessedTask::write(ostream &out) const {
+  assert(is_preprocessed());
+  const vector<Variable *> &ordering = causal_graph->get_variable_ordering();
+  generate_cpp_input_prefix(out, solveable_in_poly_time, ordering, metric,
+			    initial_state, goals, timed_goals, modules,
+			    module_index, operators, axioms, name, shared_vars,
+			    shared_vars_number, variables);
+  generate_cpp_input_suffix(out, ordering, *successor_generator,
+			    transition_graphs, *causal_graph);
+}
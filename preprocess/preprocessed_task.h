@@ -0,0 +1,111 @@
+/*********************************************************************
+ * This file is part of LAMA.
+ *
+ * LAMA is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the license, or (at your option) any later version.
+ *
+ * LAMA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ *********************************************************************/
+
+#ifndef PREPROCESSED_TASK_H
+#define PREPROCESSED_TASK_H
+
+/*
+  In-process interface to the preprocessor, built into libpreprocess
+  together with everything except planner.cc ("make lib").
+
+    PreprocessedTask task;
+    task.read(in);          // translator output, e.g. an istringstream
+    if(task.preprocess())
+      task.write(out);      // same text as the "output" file
+
+  read() parses the task; until preprocess() the accessors give the parsed
+  variables, operators and axioms. preprocess() builds the causal graph,
+  strips the operators and axioms and builds the DTGs and the successor
+  generator, which are then available as objects. Options are the same g_
+  globals the program sets from its command line (g_do_not_prune_variables
+  is set by the program for every run with an input file). The cleanup and
+  analysis passes behind options (--dedup, --h2-mutexes, --landmarks, ...)
+  and the sections they append are only run by the program.
+*/
+
+#include "state.h"
+#include "operator.h"
+#include "axiom.h"
+#include "variable.h"
+#include "domain_transition_graph.h"
+#include "module_index.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+using namespace std;
+
+class CausalGraph;
+class ConditionPool;
+class FactIndex;
+class SuccessorGenerator;
+
+class PreprocessedTask {
+  string name;
+  string metric;
+  vector<Variable> internal_variables;
+  vector<Variable *> variables;
+  State initial_state;
+  vector<pair<Variable *, int> > goals;
+  vector<pair<pair<Variable*, int>, vector<pair<pair<Variable*, int>, double> > > > timed_goals;
+  vector<Operator> operators;
+  OperatorArena operator_arena;
+  vector<Axiom> axioms;
+  vector<Variable *> shared_vars;
+  vector<int> shared_vars_number;
+  vector<pair<string, vector<pair<string, vector<pair<string, string> > > > > > modules;
+
+  FactIndex *facts;
+  ConditionPool *conditions;
+  CausalGraph *causal_graph;
+  SuccessorGenerator *successor_generator;
+  vector<DomainTransitionGraph> transition_graphs;
+  ModuleIndex module_index;
+  bool solveable_in_poly_time;
+
+  // Operators and variables point into the arena and internal_variables.
+  PreprocessedTask(const PreprocessedTask &copy);
+  PreprocessedTask &operator=(const PreprocessedTask &copy);
+public:
+  PreprocessedTask();
+  ~PreprocessedTask();
+  void read(istream &in);
+  // Returns false if --resolve-modules finds malformed references.
+  bool preprocess();
+  bool is_preprocessed() const {return successor_generator != 0;}
+  void write(ostream &out) const;
+
+  const string &get_name() const {return name;}
+  // Variables in causal graph order after preprocess(), input order before.
+  const vector<Variable *> &get_ordered_variables() const;
+  const vector<Variable *> &get_variables() const {return variables;}
+  const State &get_initial_state() const {return initial_state;}
+  const vector<pair<Variable *, int> > &get_goals() const {return goals;}
+  const vector<Operator> &get_operators() const {return operators;}
+  const vector<Axiom> &get_axioms() const {return axioms;}
+  const vector<DomainTransitionGraph> &get_transition_graphs() const {
+    return transition_graphs;
+  }
+  const SuccessorGenerator &get_successor_generator() const {
+    return *successor_generator;
+  }
+  const CausalGraph &get_causal_graph() const {return *causal_graph;}
+  bool is_solveable_in_poly_time() const {return solveable_in_poly_time;}
+};
+
+#endif
@@ -0,0 +1,137 @@
+/*********************************************************************
+ * This file is part of LAMA.
+ *
+ * LAMA is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the license, or (at your option) any later version.
+ *
+ * LAMA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ *********************************************************************/
+
+#include "state_packing.h"
+#include "operator.h"
+#include "state.h"
+#include "variable.h"
+
+#include <algorithm>
+#include <iostream>
+#include <map>
+using namespace std;
+
+bool g_state_packing = false;
+
+// Widest first, then in level order.
+struct WiderField {
+  const vector<int> *bits;
+  WiderField(const vector<int> &b) : bits(&b) {}
+  bool operator()(int level1, int level2) const {
+    if((*bits)[level1] != (*bits)[level2])
+      return (*bits)[level1] > (*bits)[level2];
+    return level1 < level2;
+  }
+};
+
+void StatePacking::compute(const vector<Variable *> &variables,
+			   const vector<Operator> &operators,
+			   const State &initial_state) {
+  int num_levels = 0;
+  for(int i = 0; i < variables.size(); i++)
+    num_levels = max(num_levels, variables[i]->get_level() + 1);
+  vector<Variable *> var_of_level(num_levels);
+  for(int i = 0; i < variables.size(); i++)
+    if(variables[i]->get_level() != -1)
+      var_of_level[variables[i]->get_level()] = variables[i];
+
+  vector<int> bits(num_levels, 0);
+  vector<int> packed;
+  for(int level = 0; level < num_levels; level++) {
+    if(initial_state[var_of_level[level]] == -1)
+      continue;
+    int range = var_of_level[level]->get_range();
+    int width = 1;
+    while(width < 31 && (1 << width) < range)
+      width++;
+    bits[level] = width;
+    packed.push_back(level);
+  }
+
+  // affinity[l][l'] for l < l'.
+  vector<map<int, int> > affinity(num_levels);
+  for(int level = 0; level + 1 < num_levels; level++)
+    affinity[level][level + 1]++;
+  vector<int> read;
+  for(int i = 0; i < operators.size(); i++) {
+    read.clear();
+    Operator::PrevailRange prevail = operators[i].get_prevail();
+    for(int j = 0; j < prevail.size(); j++)
+      read.push_back(prevail[j].var->get_level());
+    Operator::PrePostRange pre_post = operators[i].get_propositional_effects();
+    for(int j = 0; j < pre_post.size(); j++)
+      if(pre_post[j].pre != PRE_ANY)
+	read.push_back(pre_post[j].var->get_level());
+    sort(read.begin(), read.end());
+    read.erase(unique(read.begin(), read.end()), read.end());
+    for(int j = 0; j < read.size(); j++)
+      for(int k = j + 1; k < read.size(); k++)
+	if(read[j] != -1)
+	  affinity[read[j]][read[k]]++;
+  }
+  // Make it symmetric.
+  for(int level = 0; level < num_levels; level++)
+    for(map<int, int>::iterator it = affinity[level].begin();
+	it != affinity[level].end(); ++it)
+      if(it->first > level)
+	affinity[it->first][level] = it->second;
+
+  stable_sort(packed.begin(), packed.end(), WiderField(bits));
+  fields.assign(num_levels, Field());
+  vector<int> used_bits;
+  vector<int> score;
+  for(int i = 0; i < packed.size(); i++) {
+    int level = packed[i];
+    score.assign(used_bits.size(), 0);
+    const map<int, int> &neighbours = affinity[level];
+    for(map<int, int>::const_iterator it = neighbours.begin();
+	it != neighbours.end(); ++it)
+      if(fields[it->first].word != -1)
+	score[fields[it->first].word] += it->second;
+    int best = -1;
+    for(int word = 0; word < used_bits.size(); word++) {
+      if(used_bits[word] + bits[level] > WORD_BITS)
+	continue;
+      if(best == -1 || score[word] > score[best] ||
+	 (score[word] == score[best] && used_bits[word] > used_bits[best]))
+	best = word;
+    }
+    if(best == -1) {
+      best = used_bits.size();
+      used_bits.push_back(0);
+    }
+    fields[level].word = best;
+    fields[level].shift = used_bits[best];
+    fields[level].bits = bits[level];
+    used_bits[best] += bits[level];
+  }
+  num_words = used_bits.size();
+  computed = true;
+  cout << "Packed " << packed.size() << " variables into " << num_words
+       << " words." << endl;
+}
+
+void StatePacking::generate_cpp_input(ostream &outfile) const {
+  outfile << "begin_state_packing" << endl;
+  outfile << num_words << endl;
+  outfile << fields.size() << endl;
+  for(int i = 0; i < fields.size(); i++)
+    outfile << fields[i].word << " " << fields[i].shift << " "
+	    << fields[i].bits << endl;
+  outfile << "end_state_packing" << endl;
+}
@@ -0,0 +1,71 @@
+/*********************************************************************
+ * This file is part of LAMA.
+ *
+ * LAMA is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the license, or (at your option) any later version.
+ *
+ * LAMA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ *********************************************************************/
+
+#ifndef STATE_PACKING_H
+#define STATE_PACKING_H
+
+/*
+  Layout for storing states as bit fields in 64-bit words.
+
+  Each finite-domain variable gets the smallest number of bits that holds
+  all its values (at least one). Numeric variables keep a separate
+  double and are not packed. Variables are placed first fit decreasing:
+  widest first, and each into the word with room for it that it has the
+  most affinity with, ties going to the fullest such word. Two variables
+  have affinity if they are neighbours in the variable ordering or read
+  together in operator preconditions, once per operator, so that the
+  values tested together usually come from the same word. The layout is
+  written after the main output:
+
+    begin_state_packing
+    <number of words>
+    <number of variables>
+    <word> <shift> <bits>     (one line per variable in level order;
+    ...                        "-1 0 0" for numeric variables)
+    end_state_packing
+*/
+
+#include <fstream>
+#include <vector>
+using namespace std;
+
+class Operator;
+class State;
+class Variable;
+
+extern bool g_state_packing;
+
+class StatePacking {
+  struct Field {
+    int word, shift, bits;
+    Field() : word(-1), shift(0), bits(0) {}
+  };
+  vector<Field> fields;  // by level
+  int num_words;
+  bool computed;
+public:
+  static const int WORD_BITS = 64;
+  StatePacking() : num_words(0), computed(false) {}
+  void compute(const vector<Variable *> &variables,
+	       const vector<Operator> &operators,
+	       const State &initial_state);
+  bool is_computed() const {return computed;}
+  void generate_cpp_input(ostream &outfile) const;
+};
+
+#endif
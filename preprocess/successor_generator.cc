@@ -23,6 +23,7 @@
 #include "operator.h"
 #include "successor_generator.h"
 #include "variable.h"
+#include "fact_index.h"
 
 #include <functional>
 #include <iostream>
@@ -53,7 +54,10 @@ class GeneratorBase {
 public:
   virtual ~GeneratorBase() {}
   virtual void dump(string indent) const = 0;
-  virtual void generate_cpp_input(ofstream &outfile) const = 0;
+  virtual void generate_cpp_input(ostream &outfile) const = 0;
+  // Nodes and operator entries visited for a state whose values are
+  // uniformly distributed.
+  virtual double expected_visits() const = 0;
 };
 
 class GeneratorSwitch : public GeneratorBase {
@@ -68,7 +72,8 @@ public:
 		  const vector<GeneratorBase *> &gen_for_val,
 		  GeneratorBase *default_gen);
   virtual void dump(string indent) const;
-  virtual void generate_cpp_input(ofstream &outfile) const;
+  virtual void generate_cpp_input(ostream &outfile) const;
+  virtual double expected_visits() const;
 };
 
 class GeneratorLeaf : public GeneratorBase {
@@ -76,13 +81,15 @@ class GeneratorLeaf : public GeneratorBase {
 public:
   GeneratorLeaf(list<int> &operators);
   virtual void dump(string indent) const;
-  virtual void generate_cpp_input(ofstream &outfile) const;
+  virtual void generate_cpp_input(ostream &outfile) const;
+  virtual double expected_visits() const;
 };
 
 class GeneratorEmpty : public GeneratorBase {
 public:
   virtual void dump(string indent) const;
-  virtual void generate_cpp_input(ofstream &outfile) const;
+  virtual void generate_cpp_input(ostream &outfile) const;
+  virtual double expected_visits() const;
 };
 
 GeneratorSwitch::GeneratorSwitch(Variable *switch_variable, 
@@ -115,7 +122,7 @@ void GeneratorSwitch::dump(string indent) const {
   default_generator->dump(indent + "  ");
 }
 
-void GeneratorSwitch::generate_cpp_input(ofstream &outfile) const {
+void GeneratorSwitch::generate_cpp_input(ostream &outfile) const {
   int level = switch_var->get_level();
   assert(level != -1);
   outfile << "switch " << level << endl;
@@ -132,6 +139,13 @@ void GeneratorSwitch::generate_cpp_input(ofstream &outfile) const {
   default_generator->generate_cpp_input(outfile);
 }
 
+double GeneratorSwitch::expected_visits() const {
+  double visits = 1 + immediate_ops_indices.size();
+  for(int i = 0; i < switch_var->get_range(); i++)
+    visits += generator_for_value[i]->expected_visits() / switch_var->get_range();
+  return visits + default_generator->expected_visits();
+}
+
 GeneratorLeaf::GeneratorLeaf(list<int> &ops) {
   applicable_ops_indices.swap(ops);
 }
@@ -142,52 +156,68 @@ void GeneratorLeaf::dump(string indent) const {
     cout << indent << *op_iter << endl;
 }
 
-void GeneratorLeaf::generate_cpp_input(ofstream &outfile) const {
+void GeneratorLeaf::generate_cpp_input(ostream &outfile) const {
   outfile << "check " << applicable_ops_indices.size() << endl;
   for(list<int>::const_iterator op_iter = applicable_ops_indices.begin();
       op_iter != applicable_ops_indices.end(); ++op_iter)
     outfile << *op_iter << endl;
 }
 
+double GeneratorLeaf::expected_visits() const {
+  return 1 + applicable_ops_indices.size();
+}
+
 void GeneratorEmpty::dump(string indent) const {
   cout << indent << "<empty>" << endl;
 }
 
-void GeneratorEmpty::generate_cpp_input(ofstream &outfile) const {
+void GeneratorEmpty::generate_cpp_input(ostream &outfile) const {
   outfile << "check 0" << endl;
 }
 
+double GeneratorEmpty::expected_visits() const {
+  return 1;
+}
+
+static bool has_lower_index(const Variable *v1, const Variable *v2) {
+  return v1->get_index() < v2->get_index();
+}
+
 SuccessorGenerator::SuccessorGenerator(const vector<Variable *> &variables,
-				       const vector<Operator> &operators) {
-  // We need the iterators to conditions to be stable:
+				       const vector<Operator> &operators,
+				       ConditionPool &condition_pool)
+  : pool(&condition_pool) {
+  const FactIndex &facts = condition_pool.get_fact_index();
   conditions.reserve(operators.size());
   list<int> all_operator_indices;
+  vector<int> cond;
   // For each operator
   for(int i = 0; i < operators.size(); i++) {
     const Operator *op = &operators[i];
-    Condition cond;
+    cond.clear();
     // For each prevail in the operator
     for(int j = 0; j < op->get_prevail().size(); j++) {
       Operator::Prevail prev = op->get_prevail()[j];
-      cond.push_back(make_pair(prev.var, prev.prev));
+      cond.push_back(facts.get_fact(prev.var, prev.prev));
     }
-    // For each effect, get also the pre to construct conditions
-    for(int j = 0; j < op->get_pre_post().size(); j++) {
-      Operator::PrePost pre_post = op->get_pre_post()[j];
-      if((pre_post.pre != -1) && ((pre_post.pre != -2) && (pre_post.pre != -3) && (pre_post.pre != -4) && (pre_post.pre != -5) && (pre_post.pre != -6)))
-	cond.push_back(make_pair(pre_post.var, pre_post.pre));
+    // For each (non-numeric) effect, get also the pre to construct conditions
+    Operator::PrePostRange effects = op->get_propositional_effects();
+    for(int j = 0; j < effects.size(); j++) {
+      Operator::PrePost pre_post = effects[j];
+      if(pre_post.pre != PRE_ANY)
+	cond.push_back(facts.get_fact(pre_post.var, pre_post.pre));
     }
-    sort(cond.begin(), cond.end());
-    // We finally get several vectors: operator indices, conditions and
-    // vector of pointers (iterator) to each condition in the
-    // conditions vector indexed by operator index
+    // We finally get several vectors: operator indices, conditions
+    // (interned, i.e. sorted by variable) and the position of the next
+    // condition to check, indexed by operator index
     all_operator_indices.push_back(i);
-    conditions.push_back(cond);
-    next_condition_by_op.push_back(conditions.back().begin());
+    conditions.push_back(condition_pool.intern(cond));
+    next_condition_by_op.push_back(0);
   }
   
+  // Same order as the facts in the conditions
   varOrder = variables;
-  sort(varOrder.begin(), varOrder.end());
+  sort(varOrder.begin(), varOrder.end(), has_lower_index);
 
   root = construct_recursive(0, all_operator_indices);
 }
@@ -206,6 +236,7 @@ GeneratorBase *SuccessorGenerator::construct_recursive(int switch_var_no,
     // Get a pointer to the sorted Variables and its possible values size
     Variable *switch_var = varOrder[switch_var_no];
     int number_of_children = switch_var->get_range();
+    int first_fact = pool->get_fact_index().get_first_fact(switch_var);
 
     // Create a list for each possible value of the variable
     vector<list<int> > ops_for_val_indices(number_of_children);
@@ -222,28 +253,29 @@ GeneratorBase *SuccessorGenerator::construct_recursive(int switch_var_no,
       op_indices.pop_front();
       // Assert that the operator is a valid one (>0 and <max)
       assert(op_index >= 0 && op_index < next_condition_by_op.size());
-      // Get condition iterator
-      Condition::const_iterator &cond_iter = next_condition_by_op[op_index];
-      // Assert that the size of the stored conditions is valid
-      assert(cond_iter - conditions[op_index].begin() >= 0);
-      assert(cond_iter - conditions[op_index].begin() <= conditions[op_index].size());
+      // Get condition position
+      ConditionID cond = conditions[op_index];
+      int &cond_pos = next_condition_by_op[op_index];
+      // Assert that the position in the stored conditions is valid
+      assert(cond_pos >= 0);
+      assert(cond_pos <= pool->size(cond));
       // If the extract4ed condition is the last
-      if(cond_iter == conditions[op_index].end()) {
+      if(cond_pos == pool->size(cond)) {
     	// Make the var interesting and add the operator to the applicable list
     	  var_is_interesting = true;
     	  applicable_ops_indices.push_back(op_index);
       } else {
     	  // If there exists a condition, then not immediate,
     	  all_ops_are_immediate = false;
-    	  // Get variable that presents a condition
-    	  Variable *var = cond_iter->first;
+    	  // Get the fact of the condition
+    	  int fact = *(pool->begin(cond) + cond_pos);
     	  // Get index
-    	  int val = cond_iter->second;
+    	  int val = fact - first_fact;
     	  // If the variable is the switch_var
-    	  if(var == switch_var) {
+    	  if(val >= 0 && val < number_of_children) {
     		  // Var is interesting, get next condition
     		  var_is_interesting = true;
-    		  ++cond_iter;
+    		  ++cond_pos;
     		  // Store in the operator in the values indexed list
     		  ops_for_val_indices[val].push_back(op_index);
     	  } else {
@@ -281,6 +313,7 @@ GeneratorBase *SuccessorGenerator::construct_recursive(int switch_var_no,
 
 SuccessorGenerator::SuccessorGenerator() {
   root = 0;
+  pool = 0;
 }
 
 SuccessorGenerator::~SuccessorGenerator() {
@@ -291,6 +324,10 @@ void SuccessorGenerator::dump() const {
   cout << "Successor Generator:" << endl;
   root->dump("  ");
 }
-void SuccessorGenerator::generate_cpp_input(ofstream &outfile) const {
+void SuccessorGenerator::generate_cpp_input(ostream &outfile) const {
   root->generate_cpp_input(outfile);
 }
+
+double SuccessorGenerator::expected_visits() const {
+  return root->expected_visits();
+}
@@ -29,6 +29,8 @@
 #include <map>
 using namespace std;
 
+#include "condition_pool.h"
+
 class GeneratorBase;
 class Operator;
 class Variable;
@@ -36,12 +38,13 @@ class Variable;
 class SuccessorGenerator {
   GeneratorBase *root;
 
-  typedef vector<pair<Variable *, int> > Condition;
   GeneratorBase *construct_recursive(int switchVarNo, list<int> &ops);
   SuccessorGenerator(const SuccessorGenerator &copy);
 
-  vector<Condition> conditions;
-  vector<Condition::const_iterator> next_condition_by_op;
+  const ConditionPool *pool;
+  vector<ConditionID> conditions;
+  // position of the next unchecked fact in each operator's condition
+  vector<int> next_condition_by_op;
   vector<Variable *> varOrder;
 
   // private copy constructor to forbid copying;
@@ -49,10 +52,14 @@ class SuccessorGenerator {
 public:
   SuccessorGenerator();
   SuccessorGenerator(const vector<Variable *> &variables,
-		     const vector<Operator> &operators);
+		     const vector<Operator> &operators,
+		     ConditionPool &condition_pool);
   ~SuccessorGenerator();
   void dump() const;
-  void generate_cpp_input(ofstream &outfile) const;
+  void generate_cpp_input(ostream &outfile) const;
+  // Expected number of nodes and operator entries a lookup visits if all
+  // values of a variable are equally likely.
+  double expected_visits() const;
 };
 
 #endif
@@ -0,0 +1,117 @@
+/*********************************************************************
+ * This file is part of LAMA.
+ *
+ * LAMA is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the license, or (at your option) any later version.
+ *
+ * LAMA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ *********************************************************************/
+
+#include "timed_goals.h"
+#include "variable.h"
+
+#include <algorithm>
+using namespace std;
+
+bool g_timed_goal_index = false;
+
+TimedGoalTable::TimedGoalTable(
+  const vector<pair<pair<Variable*, int>, vector<pair<pair<Variable*, int>, double> > > > &timed_goals,
+  int levels)
+  : num_levels(levels) {
+  goal_level.reserve(timed_goals.size());
+  fact_begin.reserve(timed_goals.size() + 1);
+  fact_begin.push_back(0);
+  for(int i = 0; i < timed_goals.size(); i++) {
+    goal_level.push_back(timed_goals[i].first.first->get_level());
+    const vector<pair<pair<Variable*, int>, double> > &facts = timed_goals[i].second;
+    for(int j = 0; j < facts.size(); j++) {
+      fact_level.push_back(facts[j].first.first->get_level());
+      fact_value.push_back(facts[j].first.second);
+      fact_time.push_back(facts[j].second);
+    }
+    fact_begin.push_back(fact_level.size());
+  }
+}
+
+void TimedGoalTable::generate_cpp_input(ostream &outfile,
+					const vector<int> &ordered_goal_values) const {
+  outfile << "begin_timed_goals" << endl;
+  outfile << goal_level.size() << endl;
+  for(int i = 0; i < goal_level.size(); i++) {
+    // The goal line is only written for timed goals on a variable that
+    // is also a (non-timed) goal, with the value of that goal.
+    int level = goal_level[i];
+    if(level >= 0 && level < num_levels && ordered_goal_values[level] != -1)
+      outfile << level << " " << ordered_goal_values[level] << endl;
+    outfile << fact_begin[i + 1] - fact_begin[i] << endl;
+    for(int j = fact_begin[i]; j < fact_begin[i + 1]; j++)
+      outfile << fact_level[j] << " " << fact_value[j] << " " << fact_time[j] << endl;
+  }
+  outfile << "end_timed_goals" << endl;
+}
+
+class EarlierDeadline {
+  const vector<double> &time;
+public:
+  EarlierDeadline(const vector<double> &fact_time) : time(fact_time) {}
+  bool operator()(int fact1, int fact2) const {
+    return time[fact1] < time[fact2];
+  }
+};
+
+void TimedGoalTable::generate_deadline_index(ostream &outfile) const {
+  int num_facts = fact_level.size();
+  vector<int> by_deadline(num_facts);
+  vector<int> goal_of_fact(num_facts);
+  for(int i = 0; i < goal_level.size(); i++)
+    for(int j = fact_begin[i]; j < fact_begin[i + 1]; j++)
+      goal_of_fact[j] = i;
+  for(int j = 0; j < num_facts; j++)
+    by_deadline[j] = j;
+  // Stable, so facts with the same deadline stay in input order.
+  stable_sort(by_deadline.begin(), by_deadline.end(), EarlierDeadline(fact_time));
+
+  outfile << "begin_timed_deadlines" << endl;
+  outfile << num_facts << endl;
+  for(int pos = 0; pos < num_facts; pos++) {
+    int j = by_deadline[pos];
+    outfile << fact_time[j] << " " << fact_level[j] << " " << fact_value[j]
+	    << " " << goal_of_fact[j] << endl;
+  }
+
+  // Positions in the sorted list by level, counted and then filled in
+  // like any compressed row index.
+  vector<int> level_begin(num_levels + 1, 0);
+  for(int pos = 0; pos < num_facts; pos++) {
+    int level = fact_level[by_deadline[pos]];
+    if(level >= 0 && level < num_levels)
+      level_begin[level + 1]++;
+  }
+  for(int level = 0; level < num_levels; level++)
+    level_begin[level + 1] += level_begin[level];
+  vector<int> positions(level_begin[num_levels]);
+  vector<int> next(level_begin.begin(), level_begin.end() - 1);
+  for(int pos = 0; pos < num_facts; pos++) {
+    int level = fact_level[by_deadline[pos]];
+    if(level >= 0 && level < num_levels)
+      positions[next[level]++] = pos;
+  }
+  outfile << num_levels << endl;
+  for(int level = 0; level < num_levels; level++) {
+    outfile << level_begin[level + 1] - level_begin[level];
+    for(int k = level_begin[level]; k < level_begin[level + 1]; k++)
+      outfile << " " << positions[k];
+    outfile << endl;
+  }
+  outfile << "end_timed_deadlines" << endl;
+}
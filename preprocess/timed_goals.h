@@ -0,0 +1,72 @@
+/*********************************************************************
+ * This file is part of LAMA.
+ *
+ * LAMA is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the license, or (at your option) any later version.
+ *
+ * LAMA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ *********************************************************************/
+
+#ifndef TIMED_GOALS_H
+#define TIMED_GOALS_H
+
+/*
+  Timed goals by output level.
+
+  The goal variable and the timed facts of every timed goal are stored in
+  flat arrays, with the facts of goal i in [fact_begin[i], fact_begin[i+1]).
+  Variables and facts are given by level, so the begin_timed_goals block
+  is written in one pass over the table.
+
+  With --timed-goal-index, the timed facts are also written sorted by
+  deadline, right after end_timed_goals:
+
+    begin_timed_deadlines
+    <number of timed facts>
+    <deadline> <level> <value> <timed goal>    (by increasing deadline)
+    ...
+    <number of levels>
+    <k> <position>...                          (one line per level)
+    ...
+    end_timed_deadlines
+
+  The line of a level lists the positions of its timed facts in the
+  sorted list. A search can then walk through the deadlines with a cursor
+  and find the deadlines of a variable without a scan. Facts on pruned
+  variables (level -1) appear only in the sorted list.
+*/
+
+#include <fstream>
+#include <vector>
+using namespace std;
+
+class Variable;
+
+extern bool g_timed_goal_index;
+
+class TimedGoalTable {
+  int num_levels;
+  vector<int> goal_level;
+  vector<int> fact_begin; // one more entry than goals
+  vector<int> fact_level;
+  vector<int> fact_value;
+  vector<double> fact_time;
+public:
+  TimedGoalTable(const vector<pair<pair<Variable*, int>, vector<pair<pair<Variable*, int>, double> > > > &timed_goals,
+		 int num_levels);
+  // ordered_goal_values holds the goal value of each level, or -1.
+  void generate_cpp_input(ostream &outfile,
+			  const vector<int> &ordered_goal_values) const;
+  void generate_deadline_index(ostream &outfile) const;
+};
+
+#endif
@@ -25,7 +25,7 @@
 #include <cassert>
 using namespace std;
 
-Variable::Variable(istream &in) {
+Variable::Variable(istream &in, int theIndex) : index(theIndex) {
   in >> name >> range >> layer >> isTotalTime;
   level = -1;
   necessary = false;
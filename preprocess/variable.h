@@ -27,6 +27,7 @@
 using namespace std;
 
 class Variable {
+  int index;
   int range;
   string name;
   int layer;
@@ -34,7 +35,7 @@ class Variable {
   bool necessary;
   bool isTotalTime;
 public:
-  Variable(istream &in);
+  Variable(istream &in, int index);
   void set_level(int level);
   void set_necessary(); 
   void set_isTotalTime(bool theisTotalTime);
@@ -43,6 +44,7 @@ public:
   bool is_necessary() const; 
   int get_range() const;
   string get_name() const;
+  int get_index() const {return index;}
   int get_layer() const {return layer;}
   bool is_derived() const {return layer != -1;}
   void dump() const;